@@ -1,28 +1,6 @@
-QT += core gui
+# Application (app) and the C interface as shared library linking only QtCore (sdlx)
+TEMPLATE = subdirs
 
-greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
-
-TARGET = SudokuDLX
-TEMPLATE = app
-
-DEFINES += QT_DEPRECATED_WARNINGS
-
-CONFIG += c++11
-
-SOURCES += \
-    dlx.cpp \
-    main.cpp \
-    mainwindow.cpp
-
-HEADERS += \
-    dlx.h \
-    mainwindow.h \
-    tests.h
-
-FORMS += \
-    mainwindow.ui
-
-# Default rules for deployment.
-qnx: target.path = /tmp/$${TARGET}/bin
-else: unix:!android: target.path = /opt/$${TARGET}/bin
-!isEmpty(target.path): INSTALLS += target
+SUBDIRS += \
+    app \
+    sdlx
@@ -0,0 +1,65 @@
+QT += core gui network
+
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+
+TARGET = SudokuDLX
+TEMPLATE = app
+
+include(../common.pri)
+
+SOURCES += \
+    ../bandcounter.cpp \
+    ../benchmark.cpp \
+    ../bitsetsolver.cpp \
+    ../canonicalizer.cpp \
+    ../constraintplan.cpp \
+    ../dlx.cpp \
+    ../enumerator.cpp \
+    ../exactcover.cpp \
+    ../generator.cpp \
+    ../gridformat.cpp \
+    ../hugepages.cpp \
+    ../main.cpp \
+    ../mainwindow.cpp \
+    ../minimizer.cpp \
+    ../multigrid.cpp \
+    ../rater.cpp \
+    ../solvecache.cpp \
+    ../solver.cpp \
+    ../solverdaemon.cpp \
+    ../solverpool.cpp \
+    ../solvestore.cpp \
+    ../table4x4.cpp
+
+HEADERS += \
+    ../bandcounter.h \
+    ../benchmark.h \
+    ../bitsetsolver.h \
+    ../canonicalizer.h \
+    ../constraintplan.h \
+    ../dlx.h \
+    ../enumerator.h \
+    ../exactcover.h \
+    ../generator.h \
+    ../gridformat.h \
+    ../hugepages.h \
+    ../mainwindow.h \
+    ../minimizer.h \
+    ../multigrid.h \
+    ../rater.h \
+    ../solvecache.h \
+    ../solver.h \
+    ../solverdaemon.h \
+    ../solverpool.h \
+    ../solvestore.h \
+    ../table4x4.h \
+    ../trail.h \
+    ../tests.h
+
+FORMS += \
+    ../mainwindow.ui
+
+# Default rules for deployment.
+qnx: target.path = /tmp/$${TARGET}/bin
+else: unix:!android: target.path = /opt/$${TARGET}/bin
+!isEmpty(target.path): INSTALLS += target
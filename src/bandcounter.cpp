@@ -0,0 +1,648 @@
+#include "bandcounter.h"
+
+#include <QtAlgorithms>
+
+#include <algorithm>
+
+const int BandCounter::Size = 9;
+const int BandCounter::MaxSymmetricValues = 3;
+const quint64 BandCounter::MaxFillSteps = 1ULL << 22;
+const quint64 BandCounter::MaxCountSteps = 1ULL << 24;
+const int BandCounter::MaxRawEntries = 1 << 20;
+
+namespace {
+    const quint16 AllValues = 0x1FF;
+
+    // Orders of 3 column values assigned to rows 0, 1, 2 (identity first)
+    const int Orders[6][3] = {{0, 1, 2}, {0, 2, 1}, {1, 0, 2}, {1, 2, 0}, {2, 0, 1}, {2, 1, 0}};
+
+    int popCount(quint32 mask) {
+        return static_cast<int>(qPopulationCount(mask));
+    }
+
+    // Full 128-bit product of 64-bit words, from 32-bit halves
+    void multiply(quint64 a, quint64 b, quint64 &high, quint64 &low) {
+        quint64 a0 = a & 0xFFFFFFFFULL;
+        quint64 a1 = a >> 32;
+        quint64 b0 = b & 0xFFFFFFFFULL;
+        quint64 b1 = b >> 32;
+
+        quint64 p00 = a0 * b0;
+        quint64 p01 = a0 * b1;
+        quint64 p10 = a1 * b0;
+        quint64 middle = (p00 >> 32) + (p01 & 0xFFFFFFFFULL) + (p10 & 0xFFFFFFFFULL);
+
+        low = (middle << 32) | (p00 & 0xFFFFFFFFULL);
+        high = a1 * b1 + (p01 >> 32) + (p10 >> 32) + (middle >> 32);
+    }
+
+    // Values of a column set in increasing order as single bit masks
+    void columnValues(quint16 column, quint16 *values) {
+        int k = 0;
+        for (int v = 0; v < BandCounter::Size; ++v) {
+            if (column & (1 << v)) {
+                values[k++] = static_cast<quint16>(1 << v);
+            }
+        }
+    }
+}
+
+// Count
+BandCounter::Count::Count(quint64 value) : high(0), low(value) {
+}
+
+BandCounter::Count &BandCounter::Count::operator+=(const Count &other) {
+    low += other.low;
+    high += other.high + (low < other.low ? 1 : 0);
+    return *this;
+}
+
+BandCounter::Count BandCounter::Count::operator*(const Count &other) const {
+    Count result;
+    multiply(low, other.low, result.high, result.low);
+    result.high += high * other.low + low * other.high;
+    return result;
+}
+
+bool BandCounter::Count::operator==(const Count &other) const {
+    return high == other.high && low == other.low;
+}
+
+bool BandCounter::Count::operator!=(const Count &other) const {
+    return !(*this == other);
+}
+
+quint32 BandCounter::Count::divide(quint32 divisor) {
+    // Long division by 32-bit digits, each partial dividend is below divisor * 2^32
+    quint64 remainder = high % divisor;
+    high /= divisor;
+
+    quint64 part = (remainder << 32) | (low >> 32);
+    quint64 quotient = part / divisor;
+    remainder = part % divisor;
+
+    part = (remainder << 32) | (low & 0xFFFFFFFFULL);
+    low = (quotient << 32) | (part / divisor);
+    return static_cast<quint32>(part % divisor);
+}
+
+// Counter
+BandCounter::Count BandCounter::count(const Grid &puzzle) {
+    counterStats = Stats();
+
+    // Top band gets the most givens, bands can be freely reordered
+    int bandGivens[3] = {0, 0, 0};
+    for (int i = 0; i < Size; ++i) {
+        for (int j = 0; j < Size; ++j) {
+            if (puzzle.at(i).at(j) > 0) {
+                ++bandGivens[i / 3];
+            }
+        }
+    }
+    QList<int> order = {0, 1, 2};
+    std::stable_sort(order.begin(), order.end(), [&bandGivens](int a, int b) {
+        return bandGivens[a] > bandGivens[b];
+    });
+
+    cells.clear();
+    markedValues = 0;
+    for (int b = 0; b < 3; ++b) {
+        givens[b].clear();
+        for (int j = 0; j < Size; ++j) {
+            required[b][j] = 0;
+            forbidden[b][j] = 0;
+        }
+    }
+
+    // Conflicting or out of range givens have no solution
+    quint16 rows[9] = {};
+    quint16 columns[9] = {};
+    quint16 boxes[9] = {};
+    for (int b = 0; b < 3; ++b) {
+        for (int r = 0; r < 3; ++r) {
+            for (int j = 0; j < Size; ++j) {
+                int value = qMax(puzzle.at(order.at(b) * 3 + r).at(j), 0);
+                cells.append(value);
+                if (value == 0) {
+                    continue;
+                }
+
+                quint16 bit = static_cast<quint16>(1 << (value - 1));
+                int i = b * 3 + r;
+                int box = b * 3 + j / 3;
+                if (value > Size || (rows[i] & bit) || (columns[j] & bit) || (boxes[box] & bit)) {
+                    return 0;
+                }
+                rows[i] |= bit;
+                columns[j] |= bit;
+                boxes[box] |= bit;
+
+                givens[b].append({r, j, value});
+                markedValues |= bit;
+                required[b][j] |= bit;
+            }
+        }
+    }
+    for (int b = 0; b < 3; ++b) {
+        for (int j = 0; j < Size; ++j) {
+            forbidden[b][j] = columns[j] & ~required[b][j];
+        }
+    }
+
+    Count total;
+    startPath();
+    bool counted = popCount(markedValues) <= MaxSymmetricValues && countSymmetric(total);
+    if (!counted && !cancelled()) {
+        startPath();
+        counted = countDirect(total);
+    }
+    if (!counted && !cancelled()) {
+        // Sparse puzzles with many given values have too many top band fills, count by exact cover instead
+        counterStats.fallback = true;
+        DLX dlx(Size);
+        dlx.setCancel(cancel);
+        for (int i = 0; i < Size; ++i) {
+            for (int j = 0; j < Size; ++j) {
+                int value = puzzle.at(i).at(j);
+                if (value > 0) {
+                    dlx.coverCell(i, j, value);
+                }
+            }
+        }
+        total = dlx.countMemo();
+    }
+
+    counterStats.bandClasses = typeCounts.size() + rawCounts[0].size() + rawCounts[1].size() + rawCounts[2].size();
+    counterStats.residualClasses = typeResiduals.size() + rawResiduals.size();
+    return total;
+}
+
+BandCounter::Stats BandCounter::stats() const {
+    return counterStats;
+}
+
+void BandCounter::setCancel(const std::atomic<bool> *cancel) {
+    this->cancel = cancel;
+}
+
+QString BandCounter::toString(Count count) {
+    if (count == 0) {
+        return "0";
+    }
+
+    QString digits;
+    while (count != 0) {
+        digits.prepend(QChar('0' + static_cast<int>(count.divide(10))));
+    }
+    return digits;
+}
+
+// Budget
+void BandCounter::startPath() {
+    for (auto &counts : rawCounts) {
+        counts.clear();
+    }
+    rawResiduals.clear();
+    countSteps = 0;
+    exhausted = false;
+}
+
+bool BandCounter::step() {
+    if (++countSteps > MaxCountSteps || cancelled()) {
+        exhausted = true;
+    }
+    return !exhausted;
+}
+
+bool BandCounter::cancelled() const {
+    return cancel && cancel->load(std::memory_order_relaxed);
+}
+
+// Bands
+quint64 BandCounter::bandCount(int band, const quint16 *columns) {
+    if (exhausted) {
+        return 0;
+    }
+    for (int j = 0; j < Size; ++j) {
+        if ((columns[j] & required[band][j]) != required[band][j] || (columns[j] & forbidden[band][j])) {
+            return 0;
+        }
+    }
+
+    // Without givens only value types matter (values are interchangeable)
+    if (givens[band].isEmpty()) {
+        quint64 key = typeKey(columns);
+        auto it = typeCounts.constFind(key);
+        if (it != typeCounts.constEnd()) {
+            return it.value();
+        }
+        quint64 count = computeBandCount(band, columns);
+        typeCounts.insert(key, count);
+        return count;
+    }
+
+    RawKey key = rawKey(columns);
+    auto it = rawCounts[band].constFind(key);
+    if (it != rawCounts[band].constEnd()) {
+        return it.value();
+    }
+    if (rawCounts[0].size() + rawCounts[1].size() + rawCounts[2].size() + rawResiduals.size() >= MaxRawEntries) {
+        exhausted = true;
+        return 0;
+    }
+    quint64 count = computeBandCount(band, columns);
+    rawCounts[band].insert(key, count);
+    return count;
+}
+
+quint64 BandCounter::computeBandCount(int band, const quint16 *columns) const {
+    // Without givens rows are interchangeable, first column is fixed in increasing order (6 row orders)
+    bool symmetric = givens[band].isEmpty();
+
+    // Values each row must have in a stack
+    quint16 needed[3][3] = {};
+    for (auto &given : givens[band]) {
+        needed[given.column / 3][given.row] |= static_cast<quint16>(1 << (given.value - 1));
+    }
+
+    // Row masks of stacks 0 and 1 for every order of column values, packed 9 bits per row
+    QList<quint32> stacks[2];
+    for (int s = 0; s < 2; ++s) {
+        quint16 values[3][3];
+        for (int k = 0; k < 3; ++k) {
+            columnValues(columns[s * 3 + k], values[k]);
+        }
+
+        int firstOrders = symmetric && s == 0 ? 1 : 6;
+        for (int o0 = 0; o0 < firstOrders; ++o0) {
+            for (int o1 = 0; o1 < 6; ++o1) {
+                for (int o2 = 0; o2 < 6; ++o2) {
+                    quint32 packed = 0;
+                    bool valid = true;
+                    for (int r = 0; r < 3 && valid; ++r) {
+                        quint16 row = values[0][Orders[o0][r]] | values[1][Orders[o1][r]] | values[2][Orders[o2][r]];
+                        valid = (row & needed[s][r]) == needed[s][r];
+                        packed |= static_cast<quint32>(row) << (9 * r);
+                    }
+                    if (valid) {
+                        stacks[s].append(packed);
+                    }
+                }
+            }
+        }
+    }
+
+    // Stack 2 is forced, values take the row left by stacks 0 and 1
+    quint64 count = 0;
+    for (auto &a : stacks[0]) {
+        for (auto &b : stacks[1]) {
+            if (a & b) {
+                continue;
+            }
+
+            quint32 rest = ~(a | b);
+            quint16 row0 = rest & AllValues;
+            quint16 row1 = (rest >> 9) & AllValues;
+            quint16 row2 = (rest >> 18) & AllValues;
+            bool valid = (row0 & needed[2][0]) == needed[2][0] && (row1 & needed[2][1]) == needed[2][1]
+                    && (row2 & needed[2][2]) == needed[2][2];
+            for (int k = 6; k < 9 && valid; ++k) {
+                valid = popCount(row0 & columns[k]) == 1 && popCount(row1 & columns[k]) == 1;
+            }
+            if (valid) {
+                ++count;
+            }
+        }
+    }
+
+    return symmetric ? 6 * count : count;
+}
+
+// Residuals
+BandCounter::Count BandCounter::residual(const quint16 *columns) {
+    // Without givens in bottom bands, residual is invariant under stack and column permutations and relabeling
+    if (givens[1].isEmpty() && givens[2].isEmpty()) {
+        quint64 key = canonicalTypeKey(typeKey(columns));
+        auto it = typeResiduals.constFind(key);
+        if (it != typeResiduals.constEnd()) {
+            return it.value();
+        }
+        Count count = computeResidual(columns);
+        if (!exhausted) {
+            typeResiduals.insert(key, count);
+        }
+        return count;
+    }
+
+    RawKey key = rawKey(columns);
+    auto it = rawResiduals.constFind(key);
+    if (it != rawResiduals.constEnd()) {
+        return it.value();
+    }
+    if (rawCounts[0].size() + rawCounts[1].size() + rawCounts[2].size() + rawResiduals.size() >= MaxRawEntries) {
+        exhausted = true;
+        return 0;
+    }
+    Count count = computeResidual(columns);
+    if (!exhausted) {
+        rawResiduals.insert(key, count);
+    }
+    return count;
+}
+
+BandCounter::Count BandCounter::computeResidual(const quint16 *columns) {
+    // Middle band column sets per stack, each column takes 3 of the 6 values missing in the top band
+    // and the stack takes every value once (56 options per stack)
+    QList<quint32> options[3];
+    for (int s = 0; s < 3; ++s) {
+        const quint16 *top = columns + s * 3;
+        quint16 available0 = AllValues & ~top[0];
+        for (quint16 y0 = available0; y0; y0 = (y0 - 1) & available0) {
+            if (popCount(y0) != 3) {
+                continue;
+            }
+            quint16 available1 = AllValues & ~top[1] & ~y0;
+            for (quint16 y1 = available1; y1; y1 = (y1 - 1) & available1) {
+                quint16 y2 = AllValues & ~y0 & ~y1;
+                if (popCount(y1) != 3 || (y2 & top[2])) {
+                    continue;
+                }
+
+                // Givens of bottom bands must be in their column sets
+                quint16 middle[3] = {y0, y1, y2};
+                bool valid = true;
+                for (int k = 0; k < 3 && valid; ++k) {
+                    int j = s * 3 + k;
+                    quint16 bottom = AllValues & ~top[k] & ~middle[k];
+                    valid = (middle[k] & required[1][j]) == required[1][j] && (bottom & required[2][j]) == required[2][j];
+                }
+                if (valid) {
+                    options[s].append(y0 | static_cast<quint32>(y1) << 9 | static_cast<quint32>(y2) << 18);
+                }
+            }
+        }
+    }
+
+    Count total = 0;
+    quint16 middle[9];
+    quint16 bottom[9];
+    for (auto &o0 : options[0]) {
+        for (auto &o1 : options[1]) {
+            for (auto &o2 : options[2]) {
+                if (!step()) {
+                    return total;
+                }
+
+                quint32 packed[3] = {o0, o1, o2};
+                for (int j = 0; j < Size; ++j) {
+                    middle[j] = (packed[j / 3] >> (9 * (j % 3))) & AllValues;
+                    bottom[j] = AllValues & ~columns[j] & ~middle[j];
+                }
+
+                quint64 middleCount = bandCount(1, middle);
+                if (middleCount > 0) {
+                    total += Count(middleCount) * bandCount(2, bottom);
+                }
+            }
+        }
+    }
+
+    return total;
+}
+
+// Top band
+bool BandCounter::countSymmetric(Count &total) {
+    int types[9];
+    int capacity[9] = {};
+    int freeTypeCounts[27] = {};
+    total = assignTypes(0, 0, types, capacity, freeTypeCounts);
+    return !exhausted;
+}
+
+BandCounter::Count BandCounter::assignTypes(int value, int previousFreeType, int *types, int *capacity, int *freeTypeCounts) {
+    if (value == Size) {
+        if (!step()) {
+            return 0;
+        }
+
+        quint16 columns[9] = {};
+        for (int v = 0; v < Size; ++v) {
+            columns[types[v] / 9] |= static_cast<quint16>(1 << v);
+            columns[3 + types[v] / 3 % 3] |= static_cast<quint16>(1 << v);
+            columns[6 + types[v] % 3] |= static_cast<quint16>(1 << v);
+        }
+
+        quint64 topCount = bandCount(0, columns);
+        if (topCount == 0) {
+            return 0;
+        }
+        ++counterStats.topConfigurations;
+
+        // Arrangements of free values over their types
+        Count arrangements = 1;
+        int freeValues = 0;
+        for (int t = 0; t < 27; ++t) {
+            for (int k = 1; k <= freeTypeCounts[t]; ++k) {
+                arrangements = arrangements * static_cast<quint64>(++freeValues);
+                arrangements.divide(static_cast<quint32>(k));
+            }
+        }
+
+        return arrangements * topCount * residual(columns);
+    }
+
+    quint16 bit = static_cast<quint16>(1 << value);
+    bool free = !(markedValues & bit);
+
+    Count total = 0;
+    for (int type = free ? previousFreeType : 0; type < 27 && !exhausted; ++type) {
+        int stackColumns[3] = {type / 9, 3 + type / 3 % 3, 6 + type % 3};
+        bool valid = true;
+        for (int s = 0; s < 3 && valid; ++s) {
+            int j = stackColumns[s];
+            valid = capacity[j] < 3 && !(forbidden[0][j] & bit);
+            // Value given elsewhere in the stack of the top band
+            for (int k = s * 3; k < s * 3 + 3 && valid; ++k) {
+                valid = k == j || !(required[0][k] & bit);
+            }
+        }
+        if (!valid) {
+            continue;
+        }
+
+        types[value] = type;
+        for (auto &j : stackColumns) {
+            ++capacity[j];
+        }
+        if (free) {
+            ++freeTypeCounts[type];
+        }
+
+        total += assignTypes(value + 1, free ? type : previousFreeType, types, capacity, freeTypeCounts);
+
+        if (free) {
+            --freeTypeCounts[type];
+        }
+        for (auto &j : stackColumns) {
+            --capacity[j];
+        }
+    }
+
+    return total;
+}
+
+bool BandCounter::countDirect(Count &total) {
+    QList<int> band;
+    for (int k = 0; k < 27; ++k) {
+        band.append(cells.at(k));
+    }
+    quint16 rows[3] = {};
+    quint16 boxes[3] = {};
+    quint16 columns[9] = {};
+    for (int k = 0; k < 27; ++k) {
+        if (band.at(k) > 0) {
+            quint16 bit = static_cast<quint16>(1 << (band.at(k) - 1));
+            rows[k / 9] |= bit;
+            boxes[k % 9 / 3] |= bit;
+            columns[k % 9] |= bit;
+        }
+    }
+
+    QHash<RawKey, int> index;
+    QList<QList<int>> representatives;
+    QList<quint64> multiplicity;
+    fillSteps = 0;
+    if (!fillTopBand(0, band, rows, boxes, columns, index, representatives, multiplicity)) {
+        return false;
+    }
+    counterStats.topConfigurations = static_cast<quint64>(representatives.size());
+
+    // Bottom bands only see column sets of the top band
+    total = 0;
+    for (int i = 0; i < representatives.size() && !exhausted; ++i) {
+        const QList<int> &fill = representatives.at(i);
+        quint16 top[9] = {};
+        for (int k = 0; k < 27; ++k) {
+            top[k % 9] |= static_cast<quint16>(1 << (fill.at(k) - 1));
+        }
+        total += Count(multiplicity.at(i)) * residual(top);
+    }
+
+    return !exhausted;
+}
+
+bool BandCounter::fillTopBand(int cell, QList<int> &band, quint16 *rows, quint16 *boxes, quint16 *columns,
+                              QHash<RawKey, int> &index, QList<QList<int>> &representatives, QList<quint64> &multiplicity) {
+    if (++fillSteps > MaxFillSteps || cancelled()) {
+        return false;
+    }
+
+    if (cell == 27) {
+        RawKey key = rawKey(columns);
+        auto it = index.constFind(key);
+        if (it == index.constEnd()) {
+            index.insert(key, representatives.size());
+            representatives.append(band);
+            multiplicity.append(1);
+        } else {
+            ++multiplicity[it.value()];
+        }
+        return true;
+    }
+
+    if (cells.at(cell) > 0) {
+        return fillTopBand(cell + 1, band, rows, boxes, columns, index, representatives, multiplicity);
+    }
+
+    int row = cell / 9;
+    int column = cell % 9;
+    int box = column / 3;
+    quint16 available = AllValues & ~(rows[row] | boxes[box] | columns[column] | forbidden[0][column]);
+    for (int v = 0; v < Size; ++v) {
+        quint16 bit = static_cast<quint16>(1 << v);
+        if (!(available & bit)) {
+            continue;
+        }
+
+        band[cell] = v + 1;
+        rows[row] |= bit;
+        boxes[box] |= bit;
+        columns[column] |= bit;
+
+        bool completed = fillTopBand(cell + 1, band, rows, boxes, columns, index, representatives, multiplicity);
+
+        rows[row] &= ~bit;
+        boxes[box] &= ~bit;
+        columns[column] &= ~bit;
+        band[cell] = 0;
+        if (!completed) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Keys
+quint64 BandCounter::typeKey(const quint16 *columns) {
+    quint64 key = 0;
+    for (int v = 0; v < Size; ++v) {
+        quint16 bit = static_cast<quint16>(1 << v);
+        int type = 0;
+        for (int s = 0; s < 3; ++s) {
+            int k = (columns[s * 3] & bit) ? 0 : ((columns[s * 3 + 1] & bit) ? 1 : 2);
+            type = type * 3 + k;
+        }
+        key += 1ULL << (2 * type);
+    }
+    return key;
+}
+
+quint64 BandCounter::canonicalTypeKey(quint64 key) {
+    // Type index mapping for each stack order and column order within stacks (6 * 6^3)
+    static const QList<QList<int>> mappings = [] {
+        QList<QList<int>> mappings;
+        for (auto &stackOrder : Orders) {
+            for (auto &order0 : Orders) {
+                for (auto &order1 : Orders) {
+                    for (auto &order2 : Orders) {
+                        const int *columnOrders[3] = {order0, order1, order2};
+                        QList<int> mapping;
+                        for (int type = 0; type < 27; ++type) {
+                            int digits[3] = {type / 9, type / 3 % 3, type % 3};
+                            int mapped = 0;
+                            for (int s = 0; s < 3; ++s) {
+                                mapped = mapped * 3 + columnOrders[s][digits[stackOrder[s]]];
+                            }
+                            mapping.append(mapped);
+                        }
+                        mappings.append(mapping);
+                    }
+                }
+            }
+        }
+        return mappings;
+    }();
+
+    quint64 best = key;
+    for (auto &mapping : mappings) {
+        quint64 mapped = 0;
+        for (int type = 0; type < 27; ++type) {
+            mapped |= ((key >> (2 * type)) & 3) << (2 * mapping.at(type));
+        }
+        best = qMin(best, mapped);
+    }
+    return best;
+}
+
+BandCounter::RawKey BandCounter::rawKey(const quint16 *columns) {
+    quint64 low = 0;
+    quint64 high = 0;
+    for (int j = 0; j < 7; ++j) {
+        low |= static_cast<quint64>(columns[j]) << (9 * j);
+    }
+    for (int j = 7; j < Size; ++j) {
+        high |= static_cast<quint64>(columns[j]) << (9 * (j - 7));
+    }
+    return RawKey(low, high);
+}
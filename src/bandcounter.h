@@ -0,0 +1,108 @@
+#pragma once
+
+#include <QHash>
+#include <QPair>
+
+#include "dlx.h"
+
+// Exact solution counting of sparse 9x9 grids through bands (Felgenhauer-Jarvis style)
+// Bands only interact through column sets (gangsters), so completions of the top band are grouped by their column sets
+// Band counts are memoized by value types (columns of each value in the three stacks) and residuals by gangster class
+class BandCounter {
+public:
+    // 128-bit unsigned count as two 64-bit words (wraps around), the number of 9x9 grids does not fit 64 bits
+    struct Count {
+        quint64 high;
+        quint64 low;
+
+        Count(quint64 value = 0);
+
+        Count &operator+=(const Count &other);
+        Count operator*(const Count &other) const;
+        bool operator==(const Count &other) const;
+        bool operator!=(const Count &other) const;
+        // Divides in place and returns the remainder
+        quint32 divide(quint32 divisor);
+    };
+
+    static const int Size;
+    // Puzzles with more distinct given values enumerate top band fills directly (grouped by column sets)
+    static const int MaxSymmetricValues;
+    // Enumeration of top band fills stops after this many steps, the puzzle is then counted by DLX::countMemo()
+    static const quint64 MaxFillSteps;
+    // Top band configurations and middle band column sets visited by either path before it gives up (symmetric path
+    // falls back to direct, direct to DLX::countMemo())
+    static const quint64 MaxCountSteps;
+    // Band counts and residuals memoized by column sets (bands with givens) before a path gives up
+    static const int MaxRawEntries;
+
+    struct Stats {
+        quint64 topConfigurations = 0; // Top band column sets (or fills) visited
+        bool fallback = false; // Counted by DLX::countMemo() (saturates at 2^64 - 1)
+        int bandClasses = 0; // Distinct memoized band counts
+        int residualClasses = 0; // Distinct memoized residual counts (bottom bands)
+    };
+
+    // Number of solutions of 9x9 puzzle (0 with conflicting givens), memory stays bounded on every path
+    // Partial once cancelled
+    Count count(const Grid &puzzle);
+    Stats stats() const;
+    // Counting stops early once cancel is set (from any thread), null never stops
+    void setCancel(const std::atomic<bool> *cancel);
+
+    static QString toString(Count count);
+
+private:
+    using RawKey = QPair<quint64, quint64>;
+
+    struct Given {
+        int row; // Within band
+        int column;
+        int value;
+    };
+
+    QList<int> cells; // Puzzle with bands reordered (top band has most givens)
+    QList<Given> givens[3];
+    quint16 markedValues; // Values present in givens
+    // Per band and column, values that must (required) or must not (forbidden) be in its column set
+    quint16 required[3][9];
+    quint16 forbidden[3][9];
+
+    QHash<quint64, quint64> typeCounts; // Band count by value types (bands without givens)
+    QHash<RawKey, quint64> rawCounts[3]; // Band count by column sets (bands with givens)
+    QHash<quint64, Count> typeResiduals; // Residual by canonical value types (bottom bands without givens)
+    QHash<RawKey, Count> rawResiduals;
+    Stats counterStats;
+    quint64 fillSteps = 0; // Top band fill steps of countDirect()
+    quint64 countSteps = 0; // Configurations and column sets of the current path
+    bool exhausted = false; // Current path went over MaxCountSteps or MaxRawEntries (or was cancelled)
+    const std::atomic<bool> *cancel = nullptr;
+
+    // Clears the raw caches and step budget before a path
+    void startPath();
+    // Counts a step, exhausted once over MaxCountSteps or cancelled
+    bool step();
+    bool cancelled() const;
+
+    // Completions of band with column sets (9 masks of values), 0 once exhausted
+    quint64 bandCount(int band, const quint16 *columns);
+    quint64 computeBandCount(int band, const quint16 *columns) const;
+    // Completions of middle and bottom bands given top band column sets, partial once exhausted
+    Count residual(const quint16 *columns);
+    Count computeResidual(const quint16 *columns);
+
+    // Top band as value types, free values (not given) in non-decreasing type order weighted by their arrangements
+    // False once exhausted
+    bool countSymmetric(Count &total);
+    Count assignTypes(int value, int previousFreeType, int *types, int *capacity, int *freeTypeCounts);
+    // Top band fills grouped by column sets, false once over MaxFillSteps, exhausted or cancelled
+    bool countDirect(Count &total);
+    bool fillTopBand(int cell, QList<int> &band, quint16 *rows, quint16 *boxes, quint16 *columns,
+                     QHash<RawKey, int> &index, QList<QList<int>> &representatives, QList<quint64> &multiplicity);
+
+    // Value types as 27 2-bit counts of (column in stack 0, 1, 2)
+    static quint64 typeKey(const quint16 *columns);
+    // Minimal type key over stack and column permutations
+    static quint64 canonicalTypeKey(quint64 key);
+    static RawKey rawKey(const quint16 *columns);
+};
@@ -0,0 +1,914 @@
+#include "benchmark.h"
+#include "bandcounter.h"
+#include "bitsetsolver.h"
+#include "canonicalizer.h"
+#include "constraintplan.h"
+#include "exactcover.h"
+#include "gridformat.h"
+#include "hugepages.h"
+#include "tests.h"
+
+#include <QDebug>
+#include <QHash>
+#include <QPair>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <thread>
+
+#ifdef Q_OS_LINUX
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace Benchmark {
+    namespace {
+#ifdef EXACTCOVER_PREFETCH
+        const bool prefetching = true;
+#else
+        const bool prefetching = false;
+#endif
+
+        int threadCount() {
+            return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+        }
+
+        int clueCount(const Grid &sudoku) {
+            int clues = 0;
+            for (auto &row : sudoku) {
+                for (auto &value : row) {
+                    if (value > 0) {
+                        ++clues;
+                    }
+                }
+            }
+            return clues;
+        }
+
+        // Ranks and files are primary columns, followed by both diagonal families
+        // Slack rows cover a single diagonal, so diagonals can be primary (covered exactly once)
+        void queensRows(int n, bool slack, QList<int> &rowStarts, QList<int> &columns) {
+            int diagonals = 2 * n - 1;
+            rowStarts = {0};
+            columns.clear();
+            for (int rank = 0; rank < n; ++rank) {
+                for (int file = 0; file < n; ++file) {
+                    columns << rank << n + file << 2 * n + rank + file << 2 * n + diagonals + rank - file + n - 1;
+                    rowStarts.append(columns.size());
+                }
+            }
+
+            if (slack) {
+                for (int i = 2 * n; i < 2 * n + 2 * diagonals; ++i) {
+                    columns.append(i);
+                    rowStarts.append(columns.size());
+                }
+            }
+        }
+
+        // Row r (identity only for the first one) and column c permutations are primary columns r and n + c
+        // Cells are secondary columns colored by their value
+        void latinRows(int n, QList<int> &rowStarts, QList<int> &columns, QList<int> &colors) {
+            QList<int> permutation;
+            for (int i = 0; i < n; ++i) {
+                permutation.append(i);
+            }
+
+            rowStarts = {0};
+            columns.clear();
+            colors.clear();
+            for (int line = 0; line < 2 * n; ++line) {
+                bool row = line < n;
+                QList<int> values = permutation;
+                do {
+                    columns.append(line);
+                    colors.append(0);
+                    for (int i = 0; i < n; ++i) {
+                        int cell = row ? line * n + i : i * n + line - n;
+                        columns.append(2 * n + cell);
+                        colors.append(values.at(i) + 1);
+                    }
+                    rowStarts.append(columns.size());
+                } while (line > 0 && std::next_permutation(values.begin(), values.end()));
+            }
+        }
+
+        // Candidates in order of cell and value cover the cell and the value in its row, column and region
+        // Value columns are covered sizeSqrt times, either with multiplicities or as sizeSqrt copies
+        // Copies are primary columns and every candidate gets a row for each combination of their copies
+        int multiplicityRows(int sizeSqrt, bool expanded, QList<int> &rowStarts, QList<int> &columns) {
+            int size = sizeSqrt * sizeSqrt;
+            int copies = expanded ? sizeSqrt : 1;
+            int units = size * sizeSqrt * copies;
+
+            rowStarts = {0};
+            columns.clear();
+            for (int row = 0; row < size; ++row) {
+                for (int column = 0; column < size; ++column) {
+                    int region = row / sizeSqrt * sizeSqrt + column / sizeSqrt;
+                    for (int value = 0; value < sizeSqrt; ++value) {
+                        for (int combination = 0; combination < copies * copies * copies; ++combination) {
+                            columns << row * size + column
+                                    << size * size + (row * sizeSqrt + value) * copies + combination % copies
+                                    << size * size + units + (column * sizeSqrt + value) * copies
+                                       + combination / copies % copies
+                                    << size * size + 2 * units + (region * sizeSqrt + value) * copies
+                                       + combination / copies / copies;
+                            rowStarts.append(columns.size());
+                        }
+                    }
+                }
+            }
+            return size * size + 3 * units;
+        }
+
+        // Grows cages from cells in random order over neighbouring cells with values not yet in the cage
+        QList<QList<int>> killerCages(const Grid &solution, std::mt19937 &rng) {
+            int size = solution.size();
+            QList<int> cells;
+            QList<bool> caged;
+            for (int i = 0; i < size * size; ++i) {
+                cells.append(i);
+                caged.append(false);
+            }
+            std::shuffle(cells.begin(), cells.end(), rng);
+
+            QList<QList<int>> cages;
+            for (auto &start : cells) {
+                if (caged.at(start)) {
+                    continue;
+                }
+
+                int target = std::uniform_int_distribution<int>(2, 5)(rng);
+                QList<int> cage = {start};
+                int values = 1 << solution.at(start / size).at(start % size);
+                caged[start] = true;
+                for (int i = 0; i < cage.size() && cage.size() < target; ++i) {
+                    int row = cage.at(i) / size;
+                    int column = cage.at(i) % size;
+                    QList<int> neighbours = {row > 0 ? cage.at(i) - size : -1, row < size - 1 ? cage.at(i) + size : -1,
+                                             column > 0 ? cage.at(i) - 1 : -1, column < size - 1 ? cage.at(i) + 1 : -1};
+                    for (auto &cell : neighbours) {
+                        int value = cell < 0 ? 0 : solution.at(cell / size).at(cell % size);
+                        if (cell >= 0 && !caged.at(cell) && !(values & (1 << value)) && cage.size() < target) {
+                            cage.append(cell);
+                            values |= 1 << value;
+                            caged[cell] = true;
+                        }
+                    }
+                }
+                cages.append(cage);
+            }
+            return cages;
+        }
+
+        ConstraintPlan killerPlan(const Grid &solution, const QList<QList<int>> &cages) {
+            int size = solution.size();
+            ConstraintPlan plan(size);
+            for (auto &cage : cages) {
+                int sum = 0;
+                for (auto &cell : cage) {
+                    sum += solution.at(cell / size).at(cell % size);
+                }
+                plan.addCage(cage, sum);
+            }
+            return plan;
+        }
+
+        // Splits cells off their cages (as single cell cages) where another solution differs, until none is left
+        void makeUnique(const Grid &solution, QList<QList<int>> &cages) {
+            int size = solution.size();
+            while (true) {
+                DLX dlx(size, killerPlan(solution, cages).compile());
+                Grid other;
+                dlx.enumerate([&solution, &other](const Grid &grid) {
+                    if (grid != solution) {
+                        other = grid;
+                    }
+                    return other.isEmpty();
+                });
+                if (other.isEmpty()) {
+                    return;
+                }
+
+                int cell = 0;
+                while (other.at(cell / size).at(cell % size) == solution.at(cell / size).at(cell % size)) {
+                    ++cell;
+                }
+                for (auto &cage : cages) {
+                    cage.removeOne(cell);
+                }
+                cages.append(QList<int>{cell});
+            }
+        }
+
+        // Hardware event count of the calling thread (Linux perf events), unavailable elsewhere or without permission
+        class PerfCounter {
+        public:
+            enum Event {
+                TlbMisses, // Data TLB load misses
+                CacheMisses // Last level cache misses
+            };
+
+            explicit PerfCounter(Event event) {
+#ifdef Q_OS_LINUX
+                perf_event_attr attr;
+                std::memset(&attr, 0, sizeof(attr));
+                attr.size = sizeof(attr);
+                if (event == TlbMisses) {
+                    attr.type = PERF_TYPE_HW_CACHE;
+                    attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                            | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+                } else {
+                    attr.type = PERF_TYPE_HARDWARE;
+                    attr.config = PERF_COUNT_HW_CACHE_MISSES;
+                }
+                attr.disabled = 1;
+                attr.exclude_kernel = 1;
+                attr.exclude_hv = 1;
+                fd = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+#else
+                Q_UNUSED(event);
+#endif
+            }
+            ~PerfCounter() {
+#ifdef Q_OS_LINUX
+                if (fd >= 0) {
+                    close(fd);
+                }
+#endif
+            }
+
+            bool isAvailable() const {
+                return fd >= 0;
+            }
+            void start() {
+#ifdef Q_OS_LINUX
+                if (fd >= 0) {
+                    ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                    ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+                }
+#endif
+            }
+            // Events since start(), 0 if unavailable
+            quint64 stop() {
+                quint64 events = 0;
+#ifdef Q_OS_LINUX
+                if (fd >= 0) {
+                    ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+                    if (read(fd, &events, sizeof(events)) != sizeof(events)) {
+                        events = 0;
+                    }
+                }
+#endif
+                return events;
+            }
+            // Events per run as text, unknown if unavailable
+            QString perRun(quint64 events, int runs) const {
+                return isAvailable() ? QString::number(events / std::max(runs, 1)) : QString("unknown");
+            }
+
+        private:
+            int fd = -1;
+        };
+
+        // Bands (stacks) in random order, rows (columns) of each band in random order
+        QList<int> shuffledLines(int boxSize, std::mt19937 &rng) {
+            QList<int> bands;
+            for (int i = 0; i < boxSize; ++i) {
+                bands.append(i);
+            }
+            std::shuffle(bands.begin(), bands.end(), rng);
+
+            QList<int> lines;
+            for (auto &band : bands) {
+                QList<int> bandLines;
+                for (int i = 0; i < boxSize; ++i) {
+                    bandLines.append(band * boxSize + i);
+                }
+                std::shuffle(bandLines.begin(), bandLines.end(), rng);
+                lines.append(bandLines);
+            }
+            return lines;
+        }
+
+        // Pattern solution of a grid with square boxes under a random symmetry, about givenPercent of its cells given
+        Grid largePuzzle(int size, int givenPercent, std::mt19937 &rng) {
+            int boxSize = static_cast<int>(std::lround(std::sqrt(size)));
+            Grid pattern;
+            for (int i = 0; i < size; ++i) {
+                GridRow row;
+                for (int j = 0; j < size; ++j) {
+                    row.append((boxSize * (i % boxSize) + i / boxSize + j) % size + 1);
+                }
+                pattern.append(row);
+            }
+
+            Transform transform;
+            transform.transpose = rng() % 2 == 1;
+            transform.rows = shuffledLines(boxSize, rng);
+            transform.columns = shuffledLines(boxSize, rng);
+            for (int i = 0; i <= size; ++i) {
+                transform.labels.append(i);
+            }
+            std::shuffle(transform.labels.begin() + 1, transform.labels.end(), rng);
+
+            Grid puzzle = transform.apply(pattern);
+            for (auto &row : puzzle) {
+                for (auto &value : row) {
+                    if (static_cast<int>(rng() % 100) >= givenPercent) {
+                        value = 0;
+                    }
+                }
+            }
+            return puzzle;
+        }
+
+        // Replaces colored secondary column i by primary columns for its color (D) and each of its rows (P)
+        // Rows take their own P, slack rows take D with P of all other colors or a single P of an unused row
+        // Equivalent if every colored column ends up used by some row (otherwise each color counts once)
+        int withoutColors(int primaryColumns, QList<int> &rowStarts, QList<int> &columns, const QList<int> &colors) {
+            int rows = rowStarts.size() - 1;
+
+            // Uses of colored columns as (row, color), columns in order of appearance
+            QHash<int, QList<QPair<int, int>>> uses;
+            QList<int> coloredColumns;
+            for (int row = 0; row < rows; ++row) {
+                for (int k = rowStarts.at(row); k < rowStarts.at(row + 1); ++k) {
+                    if (columns.at(k) >= primaryColumns && colors.at(k) > 0) {
+                        if (!uses.contains(columns.at(k))) {
+                            coloredColumns.append(columns.at(k));
+                        }
+                        uses[columns.at(k)].append(qMakePair(row, colors.at(k)));
+                    }
+                }
+            }
+
+            // Extra primary columns come after original primary columns, secondary columns are shifted
+            int extra = 0;
+            QHash<int, int> decision;
+            QHash<QPair<int, int>, int> used;
+            for (auto &column : coloredColumns) {
+                decision.insert(column, primaryColumns + extra++);
+                for (auto &use : uses.value(column)) {
+                    used.insert(qMakePair(column, use.first), primaryColumns + extra++);
+                }
+            }
+
+            QList<int> starts = {0};
+            QList<int> result;
+            for (int row = 0; row < rows; ++row) {
+                for (int k = rowStarts.at(row); k < rowStarts.at(row + 1); ++k) {
+                    int column = columns.at(k);
+                    if (column < primaryColumns) {
+                        result.append(column);
+                    } else if (colors.at(k) > 0) {
+                        result.append(used.value(qMakePair(column, row)));
+                    } else {
+                        result.append(column + extra);
+                    }
+                }
+                starts.append(result.size());
+            }
+
+            for (auto &column : coloredColumns) {
+                const QList<QPair<int, int>> &columnUses = uses[column];
+                QList<int> distinct;
+                for (auto &use : columnUses) {
+                    if (!distinct.contains(use.second)) {
+                        distinct.append(use.second);
+                    }
+                    result.append(used.value(qMakePair(column, use.first)));
+                    starts.append(result.size());
+                }
+
+                for (auto &color : distinct) {
+                    result.append(decision.value(column));
+                    for (auto &use : columnUses) {
+                        if (use.second != color) {
+                            result.append(used.value(qMakePair(column, use.first)));
+                        }
+                    }
+                    starts.append(result.size());
+                }
+            }
+
+            rowStarts = starts;
+            columns = result;
+            return primaryColumns + extra;
+        }
+    }
+
+    void generator(const Generator::Options &options, int count) {
+        int threads = threadCount();
+
+        auto benchStart = std::chrono::high_resolution_clock::now();
+        QList<Grid> puzzles = Generator::generate(options, count, threads, 0);
+        auto benchEnd = std::chrono::high_resolution_clock::now();
+
+        double seconds = std::chrono::duration<double>(benchEnd - benchStart).count();
+        double clues = 0.0;
+        for (auto &puzzle : puzzles) {
+            clues += clueCount(puzzle);
+        }
+
+        qInfo() << "- Generator" << QString::number(options.size) + "x" + QString::number(options.size) + ":"
+                << puzzles.size() << "puzzles on" << threads << "threads in" << seconds * 1000.0 << "milliseconds"
+                << "(" + QString::number(puzzles.size() / seconds) << "puzzles/second, average"
+                << clues / puzzles.size() << "clues)";
+    }
+
+    void canonicalizer(int size, int count) {
+        Generator::Options options;
+        options.size = size;
+        QList<Grid> puzzles;
+        QList<Grid> solutions;
+        Generator generator(options, 0);
+        for (int i = 0; i < count; ++i) {
+            puzzles.append(generator.generate());
+            solutions.append(generator.solution());
+        }
+
+        Canonicalizer canonicalizer(size);
+        for (auto grids : {&puzzles, &solutions}) {
+            auto benchStart = std::chrono::high_resolution_clock::now();
+            quint64 hash = 0;
+            int failed = 0;
+            for (auto &grid : *grids) {
+                Grid canonical;
+                if (canonicalizer.canonicalize(grid, canonical)) {
+                    hash ^= Canonicalizer::hash(canonical);
+                } else {
+                    ++failed;
+                }
+            }
+            auto benchEnd = std::chrono::high_resolution_clock::now();
+
+            double seconds = std::chrono::duration<double>(benchEnd - benchStart).count();
+            qInfo() << "- Canonicalizer" << QString::number(size) + "x" + QString::number(size)
+                    << (grids == &puzzles ? "puzzles:" : "solutions:") << grids->size() << "grids in"
+                    << seconds * 1000.0 << "milliseconds"
+                    << "(" + QString::number(grids->size() / seconds) << "grids/second," << failed
+                    << "over budget, hash" << hash << ")";
+        }
+    }
+
+    void counter() {
+        Grid empty;
+        for (int i = 0; i < BandCounter::Size; ++i) {
+            empty.append(GridRow(BandCounter::Size, 0));
+        }
+
+        BandCounter counter;
+        auto benchStart = std::chrono::high_resolution_clock::now();
+        BandCounter::Count count = counter.count(empty);
+        auto benchEnd = std::chrono::high_resolution_clock::now();
+
+        double seconds = std::chrono::duration<double>(benchEnd - benchStart).count();
+        BandCounter::Stats stats = counter.stats();
+        qInfo() << "- Counter 9x9 empty:" << BandCounter::toString(count) << "grids in" << seconds * 1000.0
+                << "milliseconds (" + QString::number(stats.bandClasses) << "band classes,"
+                << stats.residualClasses << "residual classes)";
+    }
+
+    void memoCounter(int givens) {
+        Generator::Options options;
+        Generator generator(options, 0);
+        generator.generate();
+        Grid solution = generator.solution();
+
+        // Givens of the solution at random cells above an empty last band (its subproblems repeat)
+        QList<int> cells;
+        for (int i = 0; i < options.size * options.size * 2 / 3; ++i) {
+            cells.append(i);
+        }
+        std::mt19937 rng(0);
+        std::shuffle(cells.begin(), cells.end(), rng);
+
+        DLX dlx(options.size);
+        for (int i = 0; i < givens; ++i) {
+            int row = cells.at(i) / options.size;
+            int column = cells.at(i) % options.size;
+            dlx.coverCell(row, column, solution.at(row).at(column));
+        }
+
+        auto benchStart = std::chrono::high_resolution_clock::now();
+        int count = dlx.count(std::numeric_limits<int>::max());
+        auto benchMiddle = std::chrono::high_resolution_clock::now();
+        quint64 memoCount = dlx.countMemo();
+        auto benchEnd = std::chrono::high_resolution_clock::now();
+
+        double seconds = std::chrono::duration<double>(benchMiddle - benchStart).count();
+        double memoSeconds = std::chrono::duration<double>(benchEnd - benchMiddle).count();
+        qInfo() << "- Counter 9x9" << givens << "givens:" << count << "/" << memoCount << "solutions in"
+                << seconds * 1000.0 << "/" << memoSeconds * 1000.0 << "milliseconds (plain / memoized,"
+                << dlx.stats().memoHits << "memo hits)";
+    }
+
+    void queens(int n) {
+        int diagonals = 2 * (2 * n - 1);
+        for (bool slack : {false, true}) {
+            QList<int> rowStarts;
+            QList<int> columns;
+            queensRows(n, slack, rowStarts, columns);
+            ExactCover cover(slack ? 2 * n + diagonals : 2 * n, slack ? 0 : diagonals, rowStarts, columns);
+
+            auto benchStart = std::chrono::high_resolution_clock::now();
+            int count = cover.count(std::numeric_limits<int>::max());
+            auto benchEnd = std::chrono::high_resolution_clock::now();
+
+            double seconds = std::chrono::duration<double>(benchEnd - benchStart).count();
+            qInfo() << "- Queens" << n << (slack ? "slack rows:" : "secondary columns:") << count << "solutions in"
+                    << seconds * 1000.0 << "milliseconds (" + QString::number(cover.rowCount()) << "rows,"
+                    << cover.stats().nodes << "nodes)";
+        }
+    }
+
+    void colors(int n) {
+        QList<int> rowStarts;
+        QList<int> columns;
+        QList<int> colors;
+        latinRows(n, rowStarts, columns, colors);
+
+        for (bool slack : {false, true}) {
+            int primaryColumns = 2 * n;
+            if (slack) {
+                primaryColumns = withoutColors(primaryColumns, rowStarts, columns, colors);
+            }
+            ExactCover cover(primaryColumns, n * n, rowStarts, columns, slack ? QList<int>() : colors);
+
+            auto benchStart = std::chrono::high_resolution_clock::now();
+            int count = cover.count(std::numeric_limits<int>::max());
+            auto benchEnd = std::chrono::high_resolution_clock::now();
+
+            double seconds = std::chrono::duration<double>(benchEnd - benchStart).count();
+            qInfo() << "- Latin squares" << n << (slack ? "slack rows:" : "colors:") << count << "solutions in"
+                    << seconds * 1000.0 << "milliseconds (" + QString::number(cover.rowCount()) << "rows,"
+                    << columns.size() << "nodes," << cover.stats().nodes << "search nodes)";
+        }
+    }
+
+    void multiplicities(int sizeSqrt, int openRows) {
+        int size = sizeSqrt * sizeSqrt;
+
+        // Complete grid with every value sizeSqrt times in each row, column and region (sudoku pattern with values
+        // grouped into sizeSqrt classes), the givens are its cells above the open rows
+        QList<int> values;
+        for (int row = 0; row < size; ++row) {
+            for (int column = 0; column < size; ++column) {
+                values.append((sizeSqrt * (row % sizeSqrt) + row / sizeSqrt + column) % size / sizeSqrt);
+            }
+        }
+
+        // Both encodings enumerate every completion, expanded solutions repeat each grid for every permutation of
+        // the free copies
+        QHash<QByteArray, int> grids[2];
+        for (bool expanded : {false, true}) {
+            QList<int> rowStarts;
+            QList<int> columns;
+            int primaryColumns = multiplicityRows(sizeSqrt, expanded, rowStarts, columns);
+            ExactCover cover(primaryColumns, 0, rowStarts, columns);
+            if (!expanded) {
+                for (int i = size * size; i < primaryColumns; ++i) {
+                    cover.setMultiplicity(i, sizeSqrt, sizeSqrt);
+                }
+            }
+
+            // Each given takes the next free copy of its value in its row, column and region
+            int copies = expanded ? sizeSqrt : 1;
+            QList<int> used;
+            for (int i = 0; i < 3 * size * sizeSqrt; ++i) {
+                used.append(0);
+            }
+            for (int cell = 0; cell < (size - openRows) * size; ++cell) {
+                int row = cell / size;
+                int column = cell % size;
+                int region = row / sizeSqrt * sizeSqrt + column / sizeSqrt;
+                int value = values.at(cell);
+                int rowCopy = used[row * sizeSqrt + value]++;
+                int columnCopy = used[(size + column) * sizeSqrt + value]++;
+                int regionCopy = used[(2 * size + region) * sizeSqrt + value]++;
+                int combination = expanded ? rowCopy + copies * (columnCopy + copies * regionCopy) : 0;
+                cover.coverRow((cell * sizeSqrt + value) * copies * copies * copies + combination);
+            }
+
+            int rowsPerCell = cover.rowCount() / (size * size);
+            QHash<QByteArray, int> &distinct = grids[expanded ? 1 : 0];
+            auto benchStart = std::chrono::high_resolution_clock::now();
+            int count = cover.enumerate([&](const QList<int> &rows) {
+                QByteArray grid(size * size, 0);
+                for (auto &row : rows) {
+                    grid[row / rowsPerCell] = static_cast<char>(row % rowsPerCell * sizeSqrt / rowsPerCell + 1);
+                }
+                distinct.insert(grid, 0);
+                return true;
+            });
+            auto benchEnd = std::chrono::high_resolution_clock::now();
+
+            bool same = true;
+            if (expanded) {
+                same = grids[0].size() == grids[1].size();
+                for (auto it = grids[0].constBegin(); it != grids[0].constEnd() && same; ++it) {
+                    same = grids[1].contains(it.key());
+                }
+            }
+
+            double seconds = std::chrono::duration<double>(benchEnd - benchStart).count();
+            qInfo() << "- Multiplicities" << QString::number(size) + "x" + QString::number(size)
+                    << (expanded ? "expanded:" : "bounds:") << count << "solutions (" + QString::number(distinct.size())
+                    << (same ? "grids" : "grids, DIFFERENT") << ") in" << seconds * 1000.0
+                    << "milliseconds (" + QString::number(cover.rowCount()) << "rows," << cover.stats().nodes
+                    << "nodes)";
+        }
+    }
+
+    void killer(int count) {
+        Generator::Options options;
+        Generator generator(options, 0);
+        std::mt19937 rng(0);
+
+        QList<ConstraintPlan::Table> tables;
+        QList<Grid> solutions;
+        int cages = 0;
+        for (int i = 0; i < count; ++i) {
+            generator.generate();
+            solutions.append(generator.solution());
+            QList<QList<int>> puzzle = killerCages(solutions.last(), rng);
+            makeUnique(solutions.last(), puzzle);
+            tables.append(killerPlan(solutions.last(), puzzle).compile());
+            cages += puzzle.size();
+        }
+
+        int solved = 0;
+        quint64 nodes = 0;
+        auto benchStart = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < count; ++i) {
+            DLX dlx(options.size, tables.at(i));
+            if (dlx.count(2) == 1 && dlx.solution() == solutions.at(i)) {
+                ++solved;
+            }
+            nodes += dlx.stats().nodes;
+        }
+        auto benchEnd = std::chrono::high_resolution_clock::now();
+
+        double seconds = std::chrono::duration<double>(benchEnd - benchStart).count();
+        qInfo() << "- Killer 9x9:" << solved << "/" << count << "unique puzzles solved in" << seconds * 1000.0
+                << "milliseconds (" + QString::number(count / seconds) << "puzzles/second,"
+                << cages / std::max(count, 1) << "cages and" << nodes / std::max(count, 1) << "nodes per puzzle)";
+    }
+
+    void testPuzzles(int rounds) {
+        QList<Grid> puzzles;
+        for (auto &test : Tests::s9x9) {
+            puzzles.append(GridFormat::fromString(test.input));
+        }
+
+        // Same puzzles with narrow (16-bit) and wide (32-bit) links
+        bool narrowLinks = ExactCover::narrowLinks();
+        for (bool narrow : {true, false}) {
+            ExactCover::setNarrowLinks(narrow);
+
+            int solved = 0;
+            quint64 nodes = 0;
+            qint64 memory = 0;
+            auto benchStart = std::chrono::high_resolution_clock::now();
+            for (int round = 0; round < rounds; ++round) {
+                for (auto &puzzle : puzzles) {
+                    DLX dlx(puzzle);
+                    if (dlx.solve()) {
+                        ++solved;
+                    }
+                    nodes += dlx.stats().nodes;
+                    memory = std::max(memory, dlx.memoryUsage());
+                }
+            }
+            auto benchEnd = std::chrono::high_resolution_clock::now();
+
+            int count = rounds * puzzles.size();
+            double seconds = std::chrono::duration<double>(benchEnd - benchStart).count();
+            qInfo() << "- Tests 9x9" << (narrow ? "16-bit links:" : "32-bit links:") << count
+                    << "puzzles (" + QString::number(solved) + " solvable) in" << seconds * 1000.0
+                    << "milliseconds (" + QString::number(count / seconds) << "puzzles/second,"
+                    << nodes / std::max(count, 1) << "nodes per puzzle," << memory / 1024 << "KB matrix)";
+        }
+        ExactCover::setNarrowLinks(narrowLinks);
+    }
+
+    void zeroCopy(int rounds) {
+        QList<Grid> puzzles;
+        for (auto &test : Tests::s9x9) {
+            puzzles.append(GridFormat::fromString(test.input));
+        }
+        std::vector<quint8> givens;
+        for (auto &puzzle : puzzles) {
+            for (auto &row : puzzle) {
+                for (auto &value : row) {
+                    givens.push_back(static_cast<quint8>(value));
+                }
+            }
+        }
+        DLX dlx(9);
+
+        // Grids in and out (solver reused, givens covered and uncovered in place)
+        int solved = 0;
+        Grid last;
+        auto gridStart = std::chrono::high_resolution_clock::now();
+        for (int round = 0; round < rounds; ++round) {
+            for (auto &puzzle : puzzles) {
+                bool valid = true;
+                for (int i = 0; i < 9 && valid; ++i) {
+                    for (int j = 0; j < 9 && valid; ++j) {
+                        if (puzzle.at(i).at(j) > 0) {
+                            valid = dlx.coverCell(i, j, puzzle.at(i).at(j));
+                        }
+                    }
+                }
+                if (valid && dlx.count(1) > 0) {
+                    last = dlx.solution();
+                    ++solved;
+                }
+                while (dlx.coveredCells() > 0) {
+                    dlx.uncoverCell();
+                }
+            }
+        }
+        auto gridEnd = std::chrono::high_resolution_clock::now();
+
+        // Caller-owned buffers
+        int zeroCopySolved = 0;
+        std::vector<quint8> solution(81, 0);
+        auto bufferStart = std::chrono::high_resolution_clock::now();
+        for (int round = 0; round < rounds; ++round) {
+            for (size_t i = 0; i < givens.size(); i += 81) {
+                if (dlx.solve(&givens[i], solution.data())) {
+                    ++zeroCopySolved;
+                }
+            }
+        }
+        auto bufferEnd = std::chrono::high_resolution_clock::now();
+
+        bool same = solved == zeroCopySolved;
+        for (int i = 0; i < 81 && same; ++i) {
+            same = last.at(i / 9).at(i % 9) == solution.at(static_cast<size_t>(i));
+        }
+
+        int count = rounds * puzzles.size();
+        double gridSeconds = std::chrono::duration<double>(gridEnd - gridStart).count();
+        double bufferSeconds = std::chrono::duration<double>(bufferEnd - bufferStart).count();
+        qInfo() << "- Zero-copy 9x9:" << count << "test puzzles at" << count / gridSeconds
+                << "puzzles/second with grids and" << count / bufferSeconds << "with buffers ("
+                + QString(same ? "same" : "DIFFERENT") << "solutions)";
+    }
+
+    void trailUndo(int rounds) {
+        QList<Grid> puzzles;
+        for (auto &test : Tests::s9x9) {
+            puzzles.append(GridFormat::fromString(test.input));
+        }
+        for (auto &test : Tests::s16x16) {
+            puzzles.append(GridFormat::fromString(test.input));
+        }
+
+        // Symmetric uncover of dancing links (solver reused, givens covered and uncovered in place)
+        QList<int> dlxCounts;
+        DLX dlx9(9);
+        DLX dlx16(16);
+        auto dlxStart = std::chrono::high_resolution_clock::now();
+        for (int round = 0; round < rounds; ++round) {
+            dlxCounts.clear();
+            for (auto &puzzle : puzzles) {
+                DLX &dlx = puzzle.size() == 9 ? dlx9 : dlx16;
+                bool valid = true;
+                for (int i = 0; i < puzzle.size() && valid; ++i) {
+                    for (int j = 0; j < puzzle.size() && valid; ++j) {
+                        if (puzzle.at(i).at(j) > 0) {
+                            valid = dlx.coverCell(i, j, puzzle.at(i).at(j));
+                        }
+                    }
+                }
+                dlxCounts.append(valid ? dlx.count(2) : 0);
+                while (dlx.coveredCells() > 0) {
+                    dlx.uncoverCell();
+                }
+            }
+        }
+        auto dlxEnd = std::chrono::high_resolution_clock::now();
+
+        // Trail restore of candidate bitsets
+        QList<int> bitsetCounts;
+        BitsetSolver bitset9(9);
+        BitsetSolver bitset16(16);
+        quint64 nodes = 0;
+        quint64 restored = 0;
+        int maxTrail = 0;
+        auto bitsetStart = std::chrono::high_resolution_clock::now();
+        for (int round = 0; round < rounds; ++round) {
+            bitsetCounts.clear();
+            for (auto &puzzle : puzzles) {
+                BitsetSolver &bitset = puzzle.size() == 9 ? bitset9 : bitset16;
+                bitset.setGrid(puzzle);
+                bitsetCounts.append(bitset.count(2));
+                nodes += bitset.stats().nodes;
+                restored += bitset.stats().restored;
+                maxTrail = std::max(maxTrail, bitset.stats().maxTrail);
+            }
+        }
+        auto bitsetEnd = std::chrono::high_resolution_clock::now();
+
+        int count = rounds * puzzles.size();
+        double dlxSeconds = std::chrono::duration<double>(dlxEnd - dlxStart).count();
+        double bitsetSeconds = std::chrono::duration<double>(bitsetEnd - bitsetStart).count();
+        qInfo() << "- Trail undo:" << count << "test puzzles (9x9 and 16x16) at" << count / dlxSeconds
+                << "puzzles/second with dancing links and" << count / bitsetSeconds << "with bitsets and trail ("
+                + QString::number(static_cast<double>(restored) / std::max<quint64>(nodes, 1))
+                << "words restored per node," << maxTrail << "most on trail,"
+                << (dlxCounts == bitsetCounts ? "same" : "DIFFERENT") << "counts)";
+    }
+
+    void largeGrids(int size, int givenPercent, int count) {
+        std::mt19937 rng(static_cast<std::mt19937::result_type>(size));
+        QList<Grid> puzzles;
+        for (int i = 0; i < count; ++i) {
+            puzzles.append(largePuzzle(size, givenPercent, rng));
+        }
+
+        // Same corpus with the matrix on the heap and on huge pages
+        PerfCounter tlb(PerfCounter::TlbMisses);
+        PerfCounter cache(PerfCounter::CacheMisses);
+        bool hugePages = HugePages::isEnabled();
+        for (bool huge : {false, true}) {
+            HugePages::setEnabled(huge);
+
+            int solved = 0;
+            quint64 nodes = 0;
+            quint64 tlbMisses = 0;
+            quint64 cacheMisses = 0;
+            qint64 memory = 0;
+            double buildSeconds = 0.0;
+            double searchSeconds = 0.0;
+            for (auto &puzzle : puzzles) {
+                auto buildStart = std::chrono::high_resolution_clock::now();
+                DLX dlx(puzzle);
+                auto searchStart = std::chrono::high_resolution_clock::now();
+                tlb.start();
+                cache.start();
+                if (dlx.solve()) {
+                    ++solved;
+                }
+                cacheMisses += cache.stop();
+                tlbMisses += tlb.stop();
+                auto searchEnd = std::chrono::high_resolution_clock::now();
+
+                buildSeconds += std::chrono::duration<double>(searchStart - buildStart).count();
+                searchSeconds += std::chrono::duration<double>(searchEnd - searchStart).count();
+                nodes += dlx.stats().nodes;
+                memory = std::max(memory, dlx.memoryUsage());
+            }
+
+            QString title = QString::number(size) + "x" + QString::number(size) + (huge ? " huge pages" : " heap")
+                    + (prefetching ? " prefetch:" : ":");
+            qInfo() << "- Large" << title << solved << "/" << count
+                    << "puzzles (" + QString::number(givenPercent) + "% given) solved in"
+                    << buildSeconds * 1000.0 / std::max(count, 1) << "/" << searchSeconds * 1000.0 / std::max(count, 1)
+                    << "milliseconds per puzzle (build / search," << nodes / std::max(count, 1) << "nodes,"
+                    << tlb.perRun(tlbMisses, count) << "TLB and" << cache.perRun(cacheMisses, count)
+                    << "cache misses per puzzle," << memory / (1024 * 1024) << "MB matrix)";
+        }
+        HugePages::setEnabled(hugePages);
+    }
+
+    void run() {
+        qInfo() << "Running Benchmarks:";
+
+        Generator::Options options;
+        options.size = 9;
+        generator(options, 200);
+
+        options.size = 16;
+        generator(options, 4);
+
+        canonicalizer(9, 200);
+
+        counter();
+        memoCounter(22);
+
+        queens(12);
+        colors(5);
+        multiplicities(2, 3);
+        multiplicities(3, 1);
+        killer(20);
+        testPuzzles(100);
+        zeroCopy(100);
+        trailUndo(100);
+
+        // Corpus of generated large grids per size
+        for (int size : {16, 25, 36, 49, 64}) {
+            largeGrids(size, 70, 5);
+        }
+    }
+}
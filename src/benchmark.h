@@ -0,0 +1,39 @@
+#pragma once
+
+#include "generator.h"
+
+// Benchmarks outside of UI (run with --benchmark)
+namespace Benchmark {
+    // Generates puzzles on all available threads and reports throughput
+    void generator(const Generator::Options &options, int count);
+    // Canonicalizes generated puzzles and their solutions on one thread and reports throughput
+    void canonicalizer(int size, int count);
+    // Counts all completions of the empty 9x9 grid (6670903752021072936960)
+    void counter();
+    // Counts all solutions of a sparse 9x9 puzzle with plain and memoized DLX search
+    void memoCounter(int givens);
+    // Counts N queens solutions with diagonals as secondary columns and as primary columns with slack rows
+    void queens(int n);
+    // Counts latin squares of order n (first row fixed) from row and column permutations agreeing on colored cells
+    // and from the same rows with colors replaced by slack rows
+    void colors(int n);
+    // Lists solutions (up to the limit) of a sudoku-like grid of size sizeSqrt ^ 2 with sizeSqrt values, each used
+    // sizeSqrt times per row, column and region, with multiplicities and with columns expanded to copies
+    void multiplicities(int sizeSqrt, int limit);
+    // Solves unique killer 9x9 puzzles (cages of up to 5 cells over generated solutions, no givens), reports throughput
+    void killer(int count);
+    // Builds and solves the 9x9 test puzzles (solvable or not) the given number of times with 16-bit and 32-bit links,
+    // reports throughput of both
+    void testPuzzles(int rounds);
+    // Solves the 9x9 test puzzles on a reused solver with grids and with caller-owned buffers, reports both throughputs
+    void zeroCopy(int rounds);
+    // Counts solutions (up to 2) of the 9x9 and 16x16 test puzzles with dancing links and with candidate bitsets
+    // restored from a trail, reports throughput of both and words restored per search node
+    void trailUndo(int rounds);
+    // Solves generated grids from 16x16 on (cells of a shuffled pattern solution given with the percentage) with rows
+    // streamed into the matrix, reports build and search time, TLB and cache misses and memory of the matrix on heap
+    // and huge pages (and whether the solver prefetches)
+    void largeGrids(int size, int givenPercent, int count);
+
+    void run();
+}
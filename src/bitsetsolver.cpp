@@ -0,0 +1,227 @@
+#include "bitsetsolver.h"
+
+#include <QtAlgorithms>
+
+#include <algorithm>
+
+// Every change removes candidates of a cell (at most size - 1 of each), places a value or counts a cell as solved,
+// so a trail of cells * (size + 1) words holds all changes down to the deepest search node
+BitsetSolver::BitsetSolver(int size) : BitsetSolver(ConstraintPlan(size)) {
+}
+
+BitsetSolver::BitsetSolver(const ConstraintPlan &plan) : n(plan.size()), cells(n * n),
+        allValues(n < 64 ? (quint64(1) << n) - 1 : ~quint64(0)), candidates(static_cast<size_t>(cells), allValues),
+        values(static_cast<size_t>(cells), 0), unsolved(static_cast<quint64>(cells)), trail(cells * (n + 1)) {
+    Q_ASSERT(n <= 64);
+
+    // Distinct peers of each cell over all houses
+    QList<QList<int>> peersOfCell;
+    for (int i = 0; i < cells; ++i) {
+        peersOfCell.append(QList<int>());
+    }
+    for (auto &house : plan.houses()) {
+        for (auto &cell : house) {
+            for (auto &peer : house) {
+                if (peer != cell) {
+                    peersOfCell[cell].append(peer);
+                }
+            }
+        }
+        if (house.size() == n) {
+            fullHouses.insert(fullHouses.end(), house.begin(), house.end());
+        }
+    }
+
+    peerStarts.reserve(static_cast<size_t>(cells + 1));
+    peerStarts.push_back(0);
+    for (auto &cellPeers : peersOfCell) {
+        std::sort(cellPeers.begin(), cellPeers.end());
+        cellPeers.erase(std::unique(cellPeers.begin(), cellPeers.end()), cellPeers.end());
+        peers.insert(peers.end(), cellPeers.begin(), cellPeers.end());
+        peerStarts.push_back(static_cast<int>(peers.size()));
+    }
+
+    pending.reserve(static_cast<size_t>(cells));
+}
+
+int BitsetSolver::size() const {
+    return n;
+}
+
+bool BitsetSolver::setGrid(const Grid &sudoku) {
+    trail.undo(0);
+    consistent = true;
+
+    for (int i = 0; i < n && i < sudoku.size() && consistent; ++i) {
+        for (int j = 0; j < n && j < sudoku.at(i).size() && consistent; ++j) {
+            int value = sudoku.at(i).at(j);
+            if (value > n) {
+                consistent = false;
+            } else if (value > 0) {
+                consistent = assign(i * n + j, quint64(1) << (value - 1));
+            }
+        }
+    }
+    return consistent;
+}
+
+int BitsetSolver::count(int limit) {
+    solutionCount = 0;
+    firstSolution.clear();
+    searchStats = Stats();
+    searchStats.maxTrail = trail.mark();
+
+    if (consistent) {
+        search(limit);
+    }
+    return solutionCount;
+}
+
+Grid BitsetSolver::solution() const {
+    Grid sudoku;
+    for (int i = 0; i < n; ++i) {
+        GridRow row;
+        for (int j = 0; j < n; ++j) {
+            row.append(firstSolution.empty() ? 0 : static_cast<int>(firstSolution.at(static_cast<size_t>(i * n + j))));
+        }
+        sudoku.append(row);
+    }
+    return sudoku;
+}
+
+BitsetSolver::Stats BitsetSolver::stats() const {
+    return searchStats;
+}
+
+// Search
+void BitsetSolver::search(int limit, int depth) {
+    ++searchStats.nodes;
+    searchStats.maxDepth = std::max(searchStats.maxDepth, depth);
+    searchStats.maxTrail = std::max(searchStats.maxTrail, trail.mark());
+
+    if (unsolved == 0) {
+        if (++solutionCount == 1) {
+            firstSolution = values;
+        }
+        return;
+    }
+
+    int cell = chooseCell();
+    quint64 choices = candidates.at(static_cast<size_t>(cell));
+    if (choices & (choices - 1)) {
+        ++searchStats.branches;
+    }
+
+    while (choices && solutionCount < limit) {
+        quint64 value = choices & (~choices + 1);
+        choices &= choices - 1;
+
+        int mark = trail.mark();
+        if (assign(cell, value)) {
+            search(limit, depth + 1);
+        }
+        searchStats.restored += static_cast<quint64>(trail.mark() - mark);
+        trail.undo(mark);
+    }
+}
+
+// Propagation
+bool BitsetSolver::assign(int cell, quint64 value) {
+    quint64 &cellCandidates = candidates[static_cast<size_t>(cell)];
+    if (!(cellCandidates & value)) {
+        return false;
+    }
+
+    if (cellCandidates != value) {
+        trail.assign(cellCandidates, value);
+    }
+    pending.clear();
+    pending.push_back(cell);
+    return propagate();
+}
+
+bool BitsetSolver::propagate() {
+    for (;;) {
+        // Naked singles
+        while (!pending.empty()) {
+            int cell = pending.back();
+            pending.pop_back();
+            if (values[static_cast<size_t>(cell)] != 0) {
+                continue;
+            }
+
+            quint64 value = candidates[static_cast<size_t>(cell)];
+            trail.assign(values[static_cast<size_t>(cell)], qCountTrailingZeroBits(value) + 1);
+            trail.assign(unsolved, unsolved - 1);
+
+            for (int i = peerStarts[static_cast<size_t>(cell)]; i < peerStarts[static_cast<size_t>(cell) + 1]; ++i) {
+                quint64 &peer = candidates[static_cast<size_t>(peers[static_cast<size_t>(i)])];
+                if (peer & value) {
+                    quint64 rest = peer & ~value;
+                    if (!rest) {
+                        pending.clear();
+                        return false;
+                    }
+                    trail.assign(peer, rest);
+                    if (!(rest & (rest - 1))) {
+                        pending.push_back(peers[static_cast<size_t>(i)]);
+                    }
+                }
+            }
+        }
+
+        // Hidden singles, values left to a single cell of a full house
+        for (size_t start = 0; start < fullHouses.size(); start += static_cast<size_t>(n)) {
+            quint64 once = 0;
+            quint64 twice = 0;
+            for (size_t i = start; i < start + static_cast<size_t>(n); ++i) {
+                quint64 cellCandidates = candidates[static_cast<size_t>(fullHouses[i])];
+                twice |= once & cellCandidates;
+                once |= cellCandidates;
+            }
+            if (once != allValues) {
+                pending.clear();
+                return false;
+            }
+
+            quint64 hidden = once & ~twice;
+            for (size_t i = start; i < start + static_cast<size_t>(n) && hidden; ++i) {
+                int cell = fullHouses[i];
+                quint64 &cellCandidates = candidates[static_cast<size_t>(cell)];
+                quint64 value = cellCandidates & hidden;
+                if (value && values[static_cast<size_t>(cell)] == 0) {
+                    if (value & (value - 1)) {
+                        pending.clear();
+                        return false;
+                    }
+                    if (cellCandidates != value) {
+                        trail.assign(cellCandidates, value);
+                    }
+                    pending.push_back(cell);
+                }
+            }
+        }
+
+        if (pending.empty()) {
+            return true;
+        }
+    }
+}
+
+int BitsetSolver::chooseCell() const {
+    int best = -1;
+    uint bestCount = static_cast<uint>(n) + 1;
+    for (int cell = 0; cell < cells; ++cell) {
+        if (values[static_cast<size_t>(cell)] == 0) {
+            uint count = qPopulationCount(candidates[static_cast<size_t>(cell)]);
+            if (count < bestCount) {
+                best = cell;
+                bestCount = count;
+                if (count <= 2) {
+                    break;
+                }
+            }
+        }
+    }
+    return best;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <QObject>
+
+#include <vector>
+
+#include "dlx.h"
+#include "trail.h"
+
+// Sudoku solver over candidate bitsets (up to 64 values) with naked and hidden singles propagated after every guess
+// Propagation changes state words in any order, backtracking restores them from a trail instead of undoing in reverse
+// Houses come from a constraint plan (killer cages are not supported and left out)
+class BitsetSolver {
+public:
+    // Deterministic search statistics of the last count()
+    struct Stats {
+        quint64 nodes = 0; // Search tree nodes visited
+        quint64 branches = 0; // Visited nodes with a choice between multiple values
+        int maxDepth = 0;
+        quint64 restored = 0; // Words restored from the trail while backtracking
+        int maxTrail = 0; // Most words held on the trail at a time
+    };
+
+    explicit BitsetSolver(int size);
+    explicit BitsetSolver(const ConstraintPlan &plan);
+
+    int size() const;
+    // Replaces givens (0 for empty) and propagates them, fails on invalid or conflicting givens (no solutions then)
+    bool setGrid(const Grid &sudoku);
+    // Counts solutions up to the limit and remembers the first one found, givens are kept
+    int count(int limit = 2);
+    // First solution found by the last count()
+    Grid solution() const;
+    // Search statistics of the last count()
+    Stats stats() const;
+
+private:
+    Q_DISABLE_COPY(BitsetSolver)
+
+    int n;
+    int cells;
+    quint64 allValues;
+
+    // Peers of each cell (cells sharing a house, CSR) and cells of houses with size cells (hidden singles)
+    std::vector<int> peerStarts;
+    std::vector<int> peers;
+    std::vector<int> fullHouses; // Size cells each
+
+    // State (changed through the trail only)
+    std::vector<quint64> candidates; // Bit v - 1 for value v by cell
+    std::vector<quint64> values; // Placed value by cell (0 while unsolved)
+    quint64 unsolved;
+    bool consistent = true; // Givens did not conflict
+    Trail<quint64> trail;
+    std::vector<int> pending; // Cells left with a single candidate, not yet placed
+
+    // Search
+    // Counts solutions of the current state up to the limit, backtracking through the trail
+    void search(int limit, int depth = 0);
+    int solutionCount = 0;
+    std::vector<quint64> firstSolution;
+    Stats searchStats;
+
+    // Propagation
+    // Narrows a cell to a single value and propagates, fails if a cell or house runs out of values
+    bool assign(int cell, quint64 value);
+    // Places pending cells and removes their values from peers, then fills hidden singles until neither is left
+    bool propagate();
+    // Cell with fewest candidates of the unsolved ones
+    int chooseCell() const;
+};
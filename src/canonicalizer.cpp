@@ -0,0 +1,656 @@
+#include "canonicalizer.h"
+
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+const int Canonicalizer::MaxSize = 64;
+const int Canonicalizer::MaxCandidates = 1 << 16;
+const int Canonicalizer::MaxSteps = 1 << 22;
+
+// Transform
+Grid Transform::apply(const Grid &sudoku) const {
+    int size = sudoku.size();
+
+    Grid result;
+    result.reserve(size);
+    for (int i = 0; i < size; ++i) {
+        GridRow row;
+        row.reserve(size);
+        for (int j = 0; j < size; ++j) {
+            int value = transpose ? sudoku.at(columns.at(j)).at(rows.at(i)) : sudoku.at(rows.at(i)).at(columns.at(j));
+            row.append(value > 0 ? labels.at(value) : 0);
+        }
+        result.append(row);
+    }
+
+    return result;
+}
+
+Transform Transform::inverse() const {
+    int size = rows.size();
+
+    Transform result;
+    result.transpose = transpose;
+    for (int i = 0; i < size; ++i) {
+        result.rows.append(0);
+        result.columns.append(0);
+    }
+    for (int i = 0; i <= size; ++i) {
+        result.labels.append(0);
+    }
+
+    // Transposed output is indexed by input columns first
+    for (int i = 0; i < size; ++i) {
+        if (transpose) {
+            result.columns[rows.at(i)] = i;
+            result.rows[columns.at(i)] = i;
+        } else {
+            result.rows[rows.at(i)] = i;
+            result.columns[columns.at(i)] = i;
+        }
+        result.labels[labels.at(i + 1)] = i + 1;
+    }
+
+    return result;
+}
+
+// Canonicalizer
+Canonicalizer::Canonicalizer(int size) : size(size), hasBest(false), bestVersion(0), steps(0), failed(false) {
+    sizeSqrt = static_cast<int>(sqrt(size));
+    columnsOffset = Rows + size;
+    groupsOffset = Rows + 2 * size;
+    boundOffset = Rows + 3 * size;
+    basesOffset = boundOffset + size + 1;
+    startsOffset = basesOffset + size + 1;
+    stride = startsOffset + size + 1;
+
+    for (int t = 0; t < 2; ++t) {
+        cells[t].resize(static_cast<size_t>(size * size));
+        rowClasses[t].resize(static_cast<size_t>(size));
+        bandClasses[t].resize(static_cast<size_t>(sizeSqrt));
+        stackClasses[t].resize(static_cast<size_t>(sizeSqrt));
+    }
+    canonical.resize(static_cast<size_t>(size * size));
+    best.resize(static_cast<size_t>(size));
+    row.resize(static_cast<size_t>(size));
+
+    // Every branch individualizes a column, so a row is never evaluated more than size + 1 deep
+    scratch.resize(static_cast<size_t>((size + 2) * (stride + size)));
+}
+
+bool Canonicalizer::canonicalize(const Grid &sudoku, Grid &result, Transform *transform) {
+    for (int i = 0; i < size; ++i) {
+        for (int j = 0; j < size; ++j) {
+            int value = qMax(sudoku.at(i).at(j), 0);
+            if (value > size) {
+                return false;
+            }
+            cells[0][static_cast<size_t>(i * size + j)] = static_cast<quint8>(value);
+            cells[1][static_cast<size_t>(j * size + i)] = static_cast<quint8>(value);
+        }
+    }
+
+    // A value repeated in a row has no label order that keeps the row minimal for every order of its columns
+    for (int t = 0; t < 2; ++t) {
+        for (int r = 0; r < size; ++r) {
+            quint64 seen = 0;
+            for (int c = 0; c < size; ++c) {
+                quint8 value = cells[t][static_cast<size_t>(r * size + c)];
+                if (value > 0) {
+                    if (seen & (1ULL << (value - 1))) {
+                        return false;
+                    }
+                    seen |= 1ULL << (value - 1);
+                }
+            }
+        }
+    }
+
+    classify();
+
+    // Rows are chosen one by one, keeping only candidates tied for the minimal row
+    steps = 0;
+    failed = false;
+    for (int level = 0; level < size; ++level) {
+        if (level == 0) {
+            searchFirstRow();
+        } else {
+            searchRow(level);
+        }
+        if (failed) {
+            candidates.clear();
+            nextCandidates.clear();
+            return false;
+        }
+        memcpy(&canonical[static_cast<size_t>(level * size)], &best[0], static_cast<size_t>(size));
+    }
+
+    if (transform != nullptr) {
+        const quint8 *candidate = &candidates[0];
+
+        quint8 positions[64];
+        for (int j = 0; j < size; ++j) {
+            positions[candidate[columnsOffset + j]] = static_cast<quint8>(j);
+        }
+
+        transform->transpose = candidate[Transpose] != 0;
+        transform->rows.clear();
+        transform->columns.clear();
+        transform->labels = {0};
+        for (int i = 0; i < size; ++i) {
+            transform->rows.append(candidate[Rows + i]);
+            transform->columns.append(candidate[columnsOffset + i]);
+        }
+
+        // Values missing from grid get the remaining labels in order
+        int nextLabel = candidate[NextLabel];
+        for (int value = 1; value <= size; ++value) {
+            int column = candidate[boundOffset + value];
+            if (column == Unseen) {
+                transform->labels.append(nextLabel++);
+            } else {
+                transform->labels.append(candidate[basesOffset + value] + positions[column] - candidate[startsOffset + value]);
+            }
+        }
+    }
+
+    result.clear();
+    result.reserve(size);
+    for (int i = 0; i < size; ++i) {
+        GridRow resultRow;
+        resultRow.reserve(size);
+        for (int j = 0; j < size; ++j) {
+            resultRow.append(canonical.at(static_cast<size_t>(i * size + j)));
+        }
+        result.append(resultRow);
+    }
+
+    return true;
+}
+
+QString Canonicalizer::toString(const Grid &sudoku) {
+    QString result;
+    for (auto &row : sudoku) {
+        for (auto &value : row) {
+            if (value < 1) {
+                result.append('.');
+            } else if (value < 10) {
+                result.append(QChar('0' + value));
+            } else {
+                result.append(QChar('A' + value - 10));
+            }
+        }
+    }
+    return result;
+}
+
+quint64 Canonicalizer::hash(const Grid &sudoku) {
+    quint64 hash = 14695981039346656037ULL;
+    for (auto &row : sudoku) {
+        for (auto &value : row) {
+            hash ^= static_cast<quint64>(qMax(value, 0));
+            hash *= 1099511628211ULL;
+        }
+    }
+    return hash;
+}
+
+// Search
+void Canonicalizer::classify() {
+    for (int t = 0; t < 2; ++t) {
+        const quint8 *input = &cells[t][0];
+        for (int r = 0; r < size; ++r) {
+            rowClasses[t][static_cast<size_t>(r)] = r;
+            for (int other = 0; other < r; ++other) {
+                if (memcmp(input + other * size, input + r * size, static_cast<size_t>(size)) == 0) {
+                    rowClasses[t][static_cast<size_t>(r)] = rowClasses[t][static_cast<size_t>(other)];
+                    break;
+                }
+            }
+        }
+    }
+
+    // Bands and stacks by their sorted row and column classes (columns are rows of the other orientation)
+    std::vector<std::vector<int>> members(static_cast<size_t>(sizeSqrt));
+    for (int t = 0; t < 2; ++t) {
+        for (int pass = 0; pass < 2; ++pass) {
+            const std::vector<int> &lineClasses = rowClasses[pass == 0 ? t : 1 - t];
+            std::vector<int> &classes = pass == 0 ? bandClasses[t] : stackClasses[t];
+
+            for (int b = 0; b < sizeSqrt; ++b) {
+                std::vector<int> &lines = members[static_cast<size_t>(b)];
+                lines.assign(lineClasses.begin() + b * sizeSqrt, lineClasses.begin() + (b + 1) * sizeSqrt);
+                std::sort(lines.begin(), lines.end());
+
+                classes[static_cast<size_t>(b)] = b;
+                for (int other = 0; other < b; ++other) {
+                    if (members[static_cast<size_t>(other)] == lines) {
+                        classes[static_cast<size_t>(b)] = classes[static_cast<size_t>(other)];
+                        break;
+                    }
+                }
+            }
+        }
+    }
+}
+
+void Canonicalizer::searchFirstRow() {
+    nextCandidates.clear();
+    hasBest = false;
+    ++bestVersion;
+
+    std::vector<int> empty(static_cast<size_t>(sizeSqrt));
+    std::vector<int> stacks(static_cast<size_t>(sizeSqrt));
+    std::vector<int> keys(static_cast<size_t>(sizeSqrt));
+    std::vector<int> segmentStarts(static_cast<size_t>(sizeSqrt));
+    std::vector<int> segmentEnds(static_cast<size_t>(sizeSqrt));
+    std::vector<bool> taken(static_cast<size_t>(sizeSqrt));
+
+    // Transpose is an automorphism of symmetric grids
+    int orientations = cells[0] == cells[1] ? 1 : 2;
+    for (int t = 0; t < orientations; ++t) {
+        const quint8 *input = &cells[t][0];
+        const std::vector<int> &classes = stackClasses[t];
+
+        for (int r = 0; r < size && !failed; ++r) {
+            if (!isFirstOfClass(0, t, r, true)) {
+                continue;
+            }
+            const quint8 *cellsRow = input + r * size;
+
+            // Stacks with more empty cells first, each is its empty cells and then its values labeled in order
+            for (int k = 0; k < sizeSqrt; ++k) {
+                empty[static_cast<size_t>(k)] = 0;
+                for (int j = k * sizeSqrt; j < (k + 1) * sizeSqrt; ++j) {
+                    empty[static_cast<size_t>(k)] += cellsRow[j] == 0;
+                }
+                stacks[static_cast<size_t>(k)] = k;
+            }
+            std::sort(stacks.begin(), stacks.end(), [&](int a, int b) {
+                if (empty[static_cast<size_t>(a)] != empty[static_cast<size_t>(b)]) {
+                    return empty[static_cast<size_t>(a)] > empty[static_cast<size_t>(b)];
+                }
+                return classes[static_cast<size_t>(a)] != classes[static_cast<size_t>(b)] ?
+                       classes[static_cast<size_t>(a)] < classes[static_cast<size_t>(b)] : a < b;
+            });
+
+            int position = 0;
+            int label = 1;
+            for (auto &stack : stacks) {
+                for (int k = 0; k < sizeSqrt; ++k) {
+                    row[static_cast<size_t>(position++)] = k < empty[static_cast<size_t>(stack)] ? 0 : static_cast<quint8>(label++);
+                }
+            }
+
+            Compare compare = {false, 0, bestVersion};
+            if (!compareRow(compare, size)) {
+                continue;
+            }
+            if (compare.less) {
+                updateBest();
+            }
+
+            // Stacks tied on empty cells are tried in every order (identical stacks only in one)
+            for (int k = 0; k < sizeSqrt; ++k) {
+                keys[static_cast<size_t>(k)] = classes[static_cast<size_t>(stacks[static_cast<size_t>(k)])];
+                bool first = k == 0 || empty[static_cast<size_t>(stacks[static_cast<size_t>(k)])] !=
+                             empty[static_cast<size_t>(stacks[static_cast<size_t>(k - 1)])];
+                segmentStarts[static_cast<size_t>(k)] = first ? k : segmentStarts[static_cast<size_t>(k - 1)];
+            }
+            for (int k = sizeSqrt - 1; k >= 0; --k) {
+                bool last = k == sizeSqrt - 1 || segmentStarts[static_cast<size_t>(k + 1)] != segmentStarts[static_cast<size_t>(k)];
+                segmentEnds[static_cast<size_t>(k)] = last ? k + 1 : segmentEnds[static_cast<size_t>(k + 1)];
+            }
+
+            bool more = true;
+            while (more && !failed) {
+                quint8 *candidate = &scratch[0];
+                memset(candidate, 0, static_cast<size_t>(stride));
+                memset(candidate + boundOffset, Unseen, static_cast<size_t>(size + 1));
+                candidate[Transpose] = static_cast<quint8>(t);
+                candidate[Band] = static_cast<quint8>(r / sizeSqrt);
+                candidate[NextLabel] = 1;
+                quint64 usedRows = 1ULL << r;
+                memcpy(candidate + UsedRows, &usedRows, sizeof(usedRows));
+                candidate[Rows] = static_cast<quint8>(r);
+
+                std::fill(taken.begin(), taken.end(), false);
+                position = 0;
+                for (int k = 0; k < sizeSqrt; ++k) {
+                    // Identical stacks of a segment are taken in order
+                    int stack = 0;
+                    for (int m = segmentStarts[static_cast<size_t>(k)]; m < segmentEnds[static_cast<size_t>(k)]; ++m) {
+                        if (!taken[static_cast<size_t>(m)] && classes[static_cast<size_t>(stacks[static_cast<size_t>(m)])] == keys[static_cast<size_t>(k)]) {
+                            taken[static_cast<size_t>(m)] = true;
+                            stack = stacks[static_cast<size_t>(m)];
+                            break;
+                        }
+                    }
+
+                    // Empty cells form a group and the values another one, bound to their columns
+                    candidate[groupsOffset + position] = 1;
+                    for (int j = stack * sizeSqrt; j < (stack + 1) * sizeSqrt; ++j) {
+                        if (cellsRow[j] == 0) {
+                            candidate[columnsOffset + position++] = static_cast<quint8>(j);
+                        }
+                    }
+                    int valuesStart = position;
+                    if (valuesStart > k * sizeSqrt && valuesStart < (k + 1) * sizeSqrt) {
+                        candidate[groupsOffset + valuesStart] = 1;
+                    }
+                    for (int j = stack * sizeSqrt; j < (stack + 1) * sizeSqrt; ++j) {
+                        quint8 value = cellsRow[j];
+                        if (value > 0) {
+                            candidate[columnsOffset + position++] = static_cast<quint8>(j);
+                            candidate[boundOffset + value] = static_cast<quint8>(j);
+                            candidate[basesOffset + value] = candidate[NextLabel];
+                            candidate[startsOffset + value] = static_cast<quint8>(valuesStart);
+                        }
+                    }
+                    candidate[NextLabel] = static_cast<quint8>(candidate[NextLabel] + position - valuesStart);
+                }
+                addCandidate(candidate);
+
+                // Next order of the last segment, carrying over into the previous ones once back in sorted order
+                more = false;
+                for (int k = sizeSqrt - 1; k >= 0 && !more; k = segmentStarts[static_cast<size_t>(k)] - 1) {
+                    more = std::next_permutation(keys.begin() + segmentStarts[static_cast<size_t>(k)],
+                                                 keys.begin() + segmentEnds[static_cast<size_t>(k)]);
+                }
+            }
+        }
+    }
+
+    candidates.swap(nextCandidates);
+}
+
+void Canonicalizer::searchRow(int level) {
+    nextCandidates.clear();
+    hasBest = false;
+    ++bestVersion;
+
+    // New output band can take any unused input band, otherwise continue in current band
+    bool newBand = level % sizeSqrt == 0;
+    size_t count = candidates.size() / static_cast<size_t>(stride);
+    for (size_t i = 0; i < count && !failed; ++i) {
+        const quint8 *candidate = &candidates[i * static_cast<size_t>(stride)];
+        int t = candidate[Transpose];
+        quint64 usedRows;
+        memcpy(&usedRows, candidate + UsedRows, sizeof(usedRows));
+
+        int firstRow = newBand ? 0 : candidate[Band] * sizeSqrt;
+        int lastRow = newBand ? size - 1 : firstRow + sizeSqrt - 1;
+        for (int r = firstRow; r <= lastRow && !failed; ++r) {
+            if ((usedRows & (1ULL << r)) || !isFirstOfClass(usedRows, t, r, newBand)) {
+                continue;
+            }
+
+            quint8 *work = &scratch[0];
+            memcpy(work, candidate, static_cast<size_t>(stride));
+            work[Band] = static_cast<quint8>(r / sizeSqrt);
+            work[Rows + level] = static_cast<quint8>(r);
+            quint64 used = usedRows | (1ULL << r);
+            memcpy(work + UsedRows, &used, sizeof(used));
+
+            quint8 *positions = work + stride;
+            for (int j = 0; j < size; ++j) {
+                positions[work[columnsOffset + j]] = static_cast<quint8>(j);
+            }
+
+            Compare compare = {false, 0, bestVersion};
+            evaluate(0, &cells[t][static_cast<size_t>(r * size)], 0, compare);
+        }
+    }
+
+    candidates.swap(nextCandidates);
+}
+
+bool Canonicalizer::isFirstOfClass(quint64 usedRows, int t, int r, bool newBand) const {
+    int band = r / sizeSqrt;
+    if (newBand) {
+        quint64 bandMask = (1ULL << sizeSqrt) - 1;
+        for (int other = 0; other < band; ++other) {
+            if (bandClasses[t][static_cast<size_t>(other)] == bandClasses[t][static_cast<size_t>(band)] &&
+                    !(usedRows & (bandMask << (other * sizeSqrt)))) {
+                return false;
+            }
+        }
+    }
+
+    for (int other = band * sizeSqrt; other < r; ++other) {
+        if (rowClasses[t][static_cast<size_t>(other)] == rowClasses[t][static_cast<size_t>(r)] && !(usedRows & (1ULL << other))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void Canonicalizer::evaluate(int depth, const quint8 *input, int start, Compare compare) {
+    if (++steps > MaxSteps) {
+        failed = true;
+        return;
+    }
+
+    quint8 *candidate = &scratch[static_cast<size_t>(depth * (stride + size))];
+    quint8 *columns = candidate + columnsOffset;
+    quint8 *groups = candidate + groupsOffset;
+    quint8 *bound = candidate + boundOffset;
+    quint8 *bases = candidate + basesOffset;
+    quint8 *starts = candidate + startsOffset;
+    quint8 *positions = candidate + stride;
+
+    while (start < size) {
+        int end = start + 1;
+        while (end < size && !groups[end]) {
+            ++end;
+        }
+
+        // Empty cells first, as a group of their own
+        int empty = 0;
+        for (int j = start; j < end; ++j) {
+            empty += input[columns[j]] == 0;
+        }
+        if (empty > 0) {
+            if (empty < end - start) {
+                quint8 ordered[64];
+                int emptyPosition = 0;
+                int valuePosition = empty;
+                for (int j = start; j < end; ++j) {
+                    quint8 column = columns[j];
+                    ordered[input[column] == 0 ? emptyPosition++ : valuePosition++] = column;
+                }
+                for (int j = start; j < end; ++j) {
+                    columns[j] = ordered[j - start];
+                    positions[columns[j]] = static_cast<quint8>(j);
+                }
+                groups[start + empty] = 1;
+            }
+
+            for (int j = start; j < start + empty; ++j) {
+                row[static_cast<size_t>(j)] = 0;
+            }
+            if (!compareRow(compare, start + empty)) {
+                return;
+            }
+            start += empty;
+            continue;
+        }
+
+        // Values bound to columns that are not individualized yet take the smallest label left in the group of their
+        // column, values that would take the same label are each tried first
+        int minimal = -1;
+        bool circular = false;
+        for (int j = start; j < end; ++j) {
+            quint8 value = input[columns[j]];
+            if (bound[value] == Unseen) {
+                continue;
+            }
+            int position = positions[bound[value]];
+            if (groups[position] && (position + 1 == size || groups[position + 1])) {
+                continue;
+            }
+
+            circular = circular || (position >= start && position < end);
+            int label = bases[value] + groupStart(candidate, position) - starts[value];
+            minimal = minimal < 0 ? label : qMin(minimal, label);
+        }
+
+        if (circular) {
+            // Value bound to a column of this very group, every column with a known value is tried first
+            for (int j = start; j < end && !failed; ++j) {
+                if (bound[input[columns[j]]] != Unseen) {
+                    individualize(branch(depth), columns[j], start);
+                    evaluate(depth + 1, input, start, compare);
+                }
+            }
+            return;
+        }
+
+        if (minimal >= 0) {
+            quint8 tied[64];
+            int tiedCount = 0;
+            for (int j = start; j < end; ++j) {
+                quint8 value = input[columns[j]];
+                int position = bound[value] == Unseen ? -1 : positions[bound[value]];
+                if (position >= 0 && !(groups[position] && (position + 1 == size || groups[position + 1])) &&
+                        bases[value] + groupStart(candidate, position) - starts[value] == minimal) {
+                    tied[tiedCount++] = bound[value];
+                }
+            }
+
+            int position = groupStart(candidate, positions[tied[0]]);
+            if (tiedCount == 1) {
+                individualize(candidate, tied[0], position);
+                continue;
+            }
+            for (int k = 0; k < tiedCount && !failed; ++k) {
+                individualize(branch(depth), tied[k], position);
+                evaluate(depth + 1, input, start, compare);
+            }
+            return;
+        }
+
+        // Known labels ascending (individualized), then values new to the group (bound to their columns)
+        quint8 keys[64];
+        for (int j = start; j < end; ++j) {
+            quint8 column = columns[j];
+            quint8 value = input[column];
+            quint8 key = bound[value] == Unseen ? Unseen :
+                         static_cast<quint8>(bases[value] + positions[bound[value]] - starts[value]);
+            int k = j;
+            for (; k > start && keys[k - 1 - start] > key; --k) {
+                keys[k - start] = keys[k - 1 - start];
+                columns[k] = columns[k - 1];
+            }
+            keys[k - start] = key;
+            columns[k] = column;
+        }
+
+        int base = candidate[NextLabel];
+        int firstNew = -1;
+        for (int j = start; j < end; ++j) {
+            quint8 column = columns[j];
+            positions[column] = static_cast<quint8>(j);
+            if (keys[j - start] != Unseen) {
+                groups[j] = 1;
+                row[static_cast<size_t>(j)] = keys[j - start];
+                continue;
+            }
+
+            if (firstNew < 0) {
+                firstNew = j;
+                groups[j] = 1;
+            }
+            quint8 value = input[column];
+            bound[value] = column;
+            bases[value] = static_cast<quint8>(base);
+            starts[value] = static_cast<quint8>(firstNew);
+            row[static_cast<size_t>(j)] = static_cast<quint8>(base + j - firstNew);
+        }
+        if (firstNew >= 0) {
+            candidate[NextLabel] = static_cast<quint8>(base + end - firstNew);
+        }
+
+        if (!compareRow(compare, end)) {
+            return;
+        }
+        start = end;
+    }
+
+    if (!compareRow(compare, size)) {
+        return;
+    }
+    if (compare.less) {
+        updateBest();
+    }
+    addCandidate(candidate);
+}
+
+bool Canonicalizer::compareRow(Compare &compare, int end) {
+    if (compare.version != bestVersion) {
+        compare.version = bestVersion;
+        compare.less = false;
+        compare.checked = 0;
+    }
+    if (!hasBest) {
+        compare.less = true;
+    }
+    if (compare.less) {
+        return true;
+    }
+
+    for (int j = compare.checked; j < end; ++j) {
+        if (row[static_cast<size_t>(j)] != best[static_cast<size_t>(j)]) {
+            if (row[static_cast<size_t>(j)] > best[static_cast<size_t>(j)]) {
+                return false;
+            }
+            compare.less = true;
+            return true;
+        }
+    }
+    compare.checked = end;
+    return true;
+}
+
+void Canonicalizer::addCandidate(const quint8 *candidate) {
+    if (nextCandidates.size() / static_cast<size_t>(stride) >= static_cast<size_t>(MaxCandidates)) {
+        failed = true;
+        return;
+    }
+    nextCandidates.insert(nextCandidates.end(), candidate, candidate + stride);
+}
+
+void Canonicalizer::updateBest() {
+    nextCandidates.clear();
+    best = row;
+    hasBest = true;
+    ++bestVersion;
+}
+
+quint8 *Canonicalizer::branch(int depth) {
+    size_t slot = static_cast<size_t>(stride + size);
+    quint8 *next = &scratch[static_cast<size_t>(depth + 1) * slot];
+    memcpy(next, &scratch[static_cast<size_t>(depth) * slot], slot);
+    return next;
+}
+
+void Canonicalizer::individualize(quint8 *candidate, int column, int position) {
+    quint8 *columns = candidate + columnsOffset;
+    quint8 *positions = candidate + stride;
+
+    int from = positions[column];
+    quint8 other = columns[position];
+    columns[from] = other;
+    positions[other] = static_cast<quint8>(from);
+    columns[position] = static_cast<quint8>(column);
+    positions[column] = static_cast<quint8>(position);
+    candidate[groupsOffset + position + 1] = 1;
+}
+
+int Canonicalizer::groupStart(const quint8 *candidate, int position) const {
+    while (!candidate[groupsOffset + position]) {
+        --position;
+    }
+    return position;
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <vector>
+
+#include "dlx.h"
+
+// Transformation within the sudoku symmetry group (validity preserving)
+// Output cell [i][j] takes value labels[input[rows[i]][columns[j]]] (input is transposed first if set)
+struct Transform {
+    bool transpose = false;
+    QList<int> rows;
+    QList<int> columns;
+    QList<int> labels; // Relabeling of values, labels[0] keeps empty cells empty
+
+    Grid apply(const Grid &sudoku) const;
+    // Transform mapping output back to input
+    Transform inverse() const;
+};
+
+// Canonical (minimal lexicographic) form of grids over the sudoku symmetry group:
+// transpose, band and row (within band) permutations, stack and column (within stack) permutations and relabeling
+// Empty cells are ordered first, so the same puzzle in any orientation gives the same canonical grid
+class Canonicalizer {
+public:
+    static const int MaxSize;
+    // Search budget, canonicalize() fails once more partial transforms are tied or more rows are evaluated
+    static const int MaxCandidates;
+    static const int MaxSteps;
+
+    explicit Canonicalizer(int size);
+
+    // Canonical form of grid and optionally the transform that maps grid to it
+    // Fails for grids with a value repeated in a row or column (no solution either) or once over budget
+    bool canonicalize(const Grid &sudoku, Grid &canonical, Transform *transform = nullptr);
+
+    // Stable string of grid ('.' for empty, 1-9 and A-Z onwards for larger values)
+    static QString toString(const Grid &sudoku);
+    // Stable 64-bit hash of grid (FNV-1a)
+    static quint64 hash(const Grid &sudoku);
+
+private:
+    // Partial transforms are stored flat with stride depending on size
+    // Columns in the same group (starting where flagged) can still be freely permuted, as all chosen rows tie on them
+    // Labels are fixed by the row a value first appears in: values new to a group are bound to their column and
+    // labeled base + (position of column - start of group), so any order of the group keeps that row minimal and
+    // the order is only chosen (column individualized) once a later row needs the label
+    // [transpose, band, next label, reserved, used rows (8), rows (size), columns (size), groups (size),
+    //  bound columns (size + 1), bases (size + 1), starts (size + 1)]
+    enum Offset {
+        Transpose = 0,
+        Band = 1,
+        NextLabel = 2,
+        UsedRows = 4,
+        Rows = 12
+    };
+
+    static const quint8 Unseen = 0xFF;
+
+    // Comparison of the row being evaluated with the minimal row (redone from the start once that changes)
+    struct Compare {
+        bool less;
+        int checked; // Positions known equal
+        quint32 version;
+    };
+
+    int size;
+    int sizeSqrt;
+    int stride;
+    int columnsOffset;
+    int groupsOffset;
+    int boundOffset;
+    int basesOffset;
+    int startsOffset;
+
+    // Input cells, original and transposed
+    std::vector<quint8> cells[2];
+    // Identical rows, bands (same rows in any order) and stacks by orientation share a class (swapping them is an
+    // automorphism of the grid, so only the first of them that is still unused is tried)
+    std::vector<int> rowClasses[2];
+    std::vector<int> bandClasses[2];
+    std::vector<int> stackClasses[2];
+    // Canonical cells (rows are final once all candidates are compared)
+    std::vector<quint8> canonical;
+
+    // Candidates tied for the minimal rows so far
+    std::vector<quint8> candidates;
+    std::vector<quint8> nextCandidates;
+
+    // Minimal row of current level
+    std::vector<quint8> best;
+    std::vector<quint8> row;
+    bool hasBest;
+    quint32 bestVersion;
+
+    // Candidate and its column positions by branch depth
+    std::vector<quint8> scratch;
+    int steps;
+    bool failed;
+
+    // Classes of identical rows, bands and stacks
+    void classify();
+    // First row of every orientation, stacks ordered by empty cells (ties in every order)
+    void searchFirstRow();
+    // Extends candidates with the rows giving the minimal row at level
+    void searchRow(int level);
+    // Whether an unused row of the candidate is the first of its class (within its band, and of its band otherwise)
+    bool isFirstOfClass(quint64 usedRows, int t, int r, bool newBand) const;
+    // Evaluates row of candidate at depth from group at start, individualizing columns of bound values as needed
+    void evaluate(int depth, const quint8 *input, int start, Compare compare);
+    // Compares row up to end with minimal row, false if greater
+    bool compareRow(Compare &compare, int end);
+    // Adds candidate tied for the minimal row
+    void addCandidate(const quint8 *candidate);
+    // Saves current row as the new minimal one (drops candidates tied for the previous one)
+    void updateBest();
+    // Copies candidate at depth into the next depth
+    quint8 *branch(int depth);
+    // Moves column to position in its group and splits it off
+    void individualize(quint8 *candidate, int column, int position);
+    // Start of group holding position
+    int groupStart(const quint8 *candidate, int position) const;
+};
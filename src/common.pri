@@ -0,0 +1,10 @@
+# Settings shared by the application and the sdlx library (sources live in this directory)
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+CONFIG += c++11
+
+INCLUDEPATH += $$PWD
+
+# Software prefetching in the cover and uncover loops of the exact cover solver (GCC and Clang)
+#DEFINES += EXACTCOVER_PREFETCH
@@ -0,0 +1,286 @@
+#include "constraintplan.h"
+
+#include <algorithm>
+#include <cmath>
+
+const int ConstraintPlan::CageTable::MaxSets = 1 << 12;
+
+ConstraintPlan::CageTable::CageTable(int size) : n(size), maxSum(size * (size + 1) / 2) {
+}
+
+const QList<quint64> &ConstraintPlan::CageTable::sets(int cells, int sum) {
+    if (sum < 0 || sum > maxSum || cells < 1 || cells > n) {
+        return none;
+    }
+
+    int key = cells * (maxSum + 1) + sum;
+    auto it = table.find(key);
+    if (it == table.end()) {
+        QList<quint64> sets;
+        collect(cells, sum, 1, 0, sets);
+        std::sort(sets.begin(), sets.end());
+        it = table.insert(key, sets);
+    }
+    return it.value();
+}
+
+void ConstraintPlan::CageTable::collect(int cells, int sum, int value, quint64 mask, QList<quint64> &sets) const {
+    // Smallest and largest sums of the remaining values
+    if (sum < cells * value + cells * (cells - 1) / 2 || sum > cells * n - cells * (cells - 1) / 2) {
+        return;
+    }
+    if (cells == 0) {
+        sets.append(mask);
+        return;
+    }
+
+    for (int v = value; v <= n && v <= sum && sets.size() <= MaxSets; ++v) {
+        collect(cells - 1, sum - v, v + 1, mask | (1ULL << (v - 1)), sets);
+    }
+}
+
+ConstraintPlan::ConstraintPlan(int size, int families, int boxRows, int boxColumns)
+        : n(size), families(families), boxRows(boxRows), boxColumns(boxColumns) {
+    // Largest divisor not above the square root gives the squarest boxes (one row for primes)
+    if (this->boxRows <= 0 || this->boxColumns <= 0 || this->boxRows * this->boxColumns != n) {
+        this->boxRows = static_cast<int>(sqrt(n));
+        while (this->boxRows > 1 && n % this->boxRows != 0) {
+            --this->boxRows;
+        }
+        this->boxColumns = n / this->boxRows;
+    }
+
+    regions.reserve(n * n);
+    for (int row = 0; row < n; ++row) {
+        for (int column = 0; column < n; ++column) {
+            regions.append(row / this->boxRows * this->boxRows + column / this->boxColumns);
+        }
+    }
+    buildHouses();
+}
+
+int ConstraintPlan::size() const {
+    return n;
+}
+
+bool ConstraintPlan::setRegions(const QList<int> &regionOfCell) {
+    if (regionOfCell.size() != n * n) {
+        return false;
+    }
+
+    QList<int> cells;
+    for (int i = 0; i < n; ++i) {
+        cells.append(0);
+    }
+    for (auto &region : regionOfCell) {
+        if (region < 0 || region >= n || ++cells[region] > n) {
+            return false;
+        }
+    }
+
+    regions = regionOfCell;
+    buildHouses();
+    return true;
+}
+
+void ConstraintPlan::addHouses(const QList<QList<int>> &houses) {
+    extraHouses.append(houses);
+    allHouses.append(houses);
+}
+
+bool ConstraintPlan::addCage(const QList<int> &cells, int sum) {
+    if (cells.size() > n || CageTable(n).sets(cells.size(), sum).size() > CageTable::MaxSets) {
+        return false;
+    }
+
+    cages.append(qMakePair(cells, sum));
+    return true;
+}
+
+const QList<QList<int>> &ConstraintPlan::houses() const {
+    return allHouses;
+}
+
+// Sparse Matrix:
+// Columns: Constraints of the puzzle (4 per number in classic grids)
+// - Each number has its own set of constraints => size ^ 2 * 4 columns (9x9 => 324 columns)
+// Rows: Every position for every number => size ^ 3 rows (9x9 = 729 rows)
+// - Each row represents only one candidate position => 4 1s in a row, representing constraints of that position
+ConstraintPlan::Table ConstraintPlan::compile() const {
+    Table table;
+    table.primaryColumns = primaryColumns();
+    table.secondaryColumns = secondaryColumns();
+    table.rowStarts.reserve(n * n * n + 1);
+    table.rowStarts.append(0);
+    compileRows([&table](const QList<int> &columns) {
+        table.columns.append(columns);
+        table.rowStarts.append(table.columns.size());
+    });
+    return table;
+}
+
+int ConstraintPlan::primaryColumns() const {
+    int primary, secondary, cageColumn, cageValueColumn;
+    layoutColumns(primary, secondary, cageColumn, cageValueColumn);
+    return primary;
+}
+
+int ConstraintPlan::secondaryColumns() const {
+    int primary, secondary, cageColumn, cageValueColumn;
+    layoutColumns(primary, secondary, cageColumn, cageValueColumn);
+    return secondary;
+}
+
+void ConstraintPlan::compileRows(const std::function<void(const QList<int> &columns)> &addRow) const {
+    int primary, secondary, cageColumn, cageValueColumn;
+    QList<int> columnOfHouse = layoutColumns(primary, secondary, cageColumn, cageValueColumn);
+
+    // Values a cell can take in any set of its cage
+    CageTable cageTable(n);
+    QList<int> cageOfCell;
+    QList<quint64> allowed;
+    for (int i = 0; i < n * n; ++i) {
+        cageOfCell.append(-1);
+        allowed.append(0);
+    }
+    for (int i = 0; i < cages.size(); ++i) {
+        quint64 values = 0;
+        for (auto &set : cageTable.sets(cages.at(i).first.size(), cages.at(i).second)) {
+            values |= set;
+        }
+        for (auto &cell : cages.at(i).first) {
+            cageOfCell[cell] = i;
+            allowed[cell] = values;
+        }
+    }
+
+    // Columns of a row are kept in ascending order
+    QList<QList<int>> housesOfCell;
+    for (int i = 0; i < n * n; ++i) {
+        housesOfCell.append(QList<int>());
+    }
+    for (int i = 0; i < allHouses.size(); ++i) {
+        for (auto &cell : allHouses.at(i)) {
+            housesOfCell[cell].append(columnOfHouse.at(i));
+        }
+    }
+    for (auto &houses : housesOfCell) {
+        std::sort(houses.begin(), houses.end());
+    }
+
+    QList<int> row;
+    for (int cell = 0; cell < n * n; ++cell) {
+        for (int value = 0; value < n; ++value) {
+            row.clear();
+            if (cageOfCell.at(cell) < 0 || (allowed.at(cell) & (1ULL << value))) {
+                row.append(cell);
+                for (auto &house : housesOfCell.at(cell)) {
+                    row.append(house + value);
+                }
+                if (cageOfCell.at(cell) >= 0) {
+                    row.append(cageValueColumn + cageOfCell.at(cell) * n + value);
+                }
+            }
+            addRow(row);
+        }
+    }
+
+    for (int i = 0; i < cages.size(); ++i) {
+        for (auto &set : cageTable.sets(cages.at(i).first.size(), cages.at(i).second)) {
+            row.clear();
+            row.append(cageColumn + i);
+            for (int value = 0; value < n; ++value) {
+                if (!(set & (1ULL << value))) {
+                    row.append(cageValueColumn + i * n + value);
+                }
+            }
+            addRow(row);
+        }
+    }
+}
+
+// Helpers
+void ConstraintPlan::buildHouses() {
+    allHouses.clear();
+    for (int i = 0; i < 3 * n; ++i) {
+        allHouses.append(QList<int>());
+    }
+    for (int cell = 0; cell < n * n; ++cell) {
+        allHouses[cell / n].append(cell);
+        allHouses[n + cell % n].append(cell);
+        allHouses[2 * n + regions.at(cell)].append(cell);
+    }
+
+    if (families & Diagonals) {
+        QList<int> main;
+        QList<int> anti;
+        for (int i = 0; i < n; ++i) {
+            main.append(i * n + i);
+            anti.append(i * n + n - 1 - i);
+        }
+        allHouses << main << anti;
+    }
+
+    if (families & Windows) {
+        for (int top = 1; top + boxRows <= n; top += boxRows + 1) {
+            for (int left = 1; left + boxColumns <= n; left += boxColumns + 1) {
+                QList<int> window;
+                for (int row = top; row < top + boxRows; ++row) {
+                    for (int column = left; column < left + boxColumns; ++column) {
+                        window.append(row * n + column);
+                    }
+                }
+                allHouses.append(window);
+            }
+        }
+    }
+
+    if (families & AntiKing) {
+        appendPairs(allHouses, {qMakePair(1, -1), qMakePair(1, 1)});
+    }
+    if (families & AntiKnight) {
+        appendPairs(allHouses, {qMakePair(1, -2), qMakePair(1, 2), qMakePair(2, -1), qMakePair(2, 1)});
+    }
+
+    allHouses.append(extraHouses);
+}
+
+QList<int> ConstraintPlan::layoutColumns(int &primary, int &secondary, int &cageColumn, int &cageValueColumn) const {
+    // Primary houses first, so their columns precede secondary ones
+    QList<int> columnOfHouse;
+    int column = n * n;
+    for (auto &house : allHouses) {
+        columnOfHouse.append(house.size() >= n ? column : -1);
+        if (house.size() >= n) {
+            column += n;
+        }
+    }
+    // Cages are primary, their values secondary (after those of houses)
+    cageColumn = column;
+    column += cages.size();
+    primary = column;
+    for (int i = 0; i < allHouses.size(); ++i) {
+        if (columnOfHouse.at(i) < 0) {
+            columnOfHouse[i] = column;
+            column += n;
+        }
+    }
+    cageValueColumn = column;
+    column += cages.size() * n;
+    secondary = column - primary;
+    return columnOfHouse;
+}
+
+void ConstraintPlan::appendPairs(QList<QList<int>> &pairs, const QList<QPair<int, int>> &offsets) const {
+    for (int row = 0; row < n; ++row) {
+        for (int column = 0; column < n; ++column) {
+            for (auto &offset : offsets) {
+                int otherRow = row + offset.first;
+                int otherColumn = column + offset.second;
+                if (otherRow < n && otherColumn >= 0 && otherColumn < n) {
+                    pairs.append({row * n + column, otherRow * n + otherColumn});
+                }
+            }
+        }
+    }
+}
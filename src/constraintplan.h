@@ -0,0 +1,95 @@
+#pragma once
+
+#include <QHash>
+#include <QObject>
+#include <QPair>
+
+#include <functional>
+
+// Declarative list of constraint families of a sudoku (variant), compiled once into rows of the exact cover matrix
+// Every house (list of cells) holds each value exactly once if it has size cells, at most once if it has fewer
+class ConstraintPlan {
+public:
+    // Extra families on top of cells, rows, columns and regions
+    enum Family {
+        Diagonals = 0x1, // Both main diagonals (X sudoku)
+        Windows = 0x2, // Boxes offset by one cell from the grid and each other (windoku)
+        AntiKing = 0x4, // Diagonally touching cells differ (orthogonal ones already share a row or column)
+        AntiKnight = 0x8 // Cells a knight's move apart differ
+    };
+
+    // Matrix in the form ExactCover takes it
+    struct Table {
+        int primaryColumns = 0;
+        int secondaryColumns = 0;
+        QList<int> rowStarts;
+        QList<int> columns;
+    };
+
+    // Value sets (bit v - 1 for value v) of distinct values by number of cells and their sum (sizes up to 64)
+    // Only sets of the requested number of cells and sum are enumerated, once on first use
+    class CageTable {
+    public:
+        // Cages with more value sets are rejected
+        static const int MaxSets;
+
+        explicit CageTable(int size);
+
+        // Sets in increasing order of their masks (stops after MaxSets + 1), empty for sums out of range
+        const QList<quint64> &sets(int cells, int sum);
+
+    private:
+        int n;
+        int maxSum;
+        QHash<int, QList<quint64>> table; // By cells * (maxSum + 1) + sum
+        QList<quint64> none;
+
+        // Appends sets of mask and cells more values from value on adding up to sum
+        void collect(int cells, int sum, int value, quint64 mask, QList<quint64> &sets) const;
+    };
+
+    // Regions are boxes of boxRows x boxColumns cells, square (or as close to square as size allows) by default
+    explicit ConstraintPlan(int size, int families = 0, int boxRows = 0, int boxColumns = 0);
+
+    int size() const;
+    // Replaces boxes with jigsaw regions by cell (row-major), fails unless every region 0 to size - 1 has size cells
+    bool setRegions(const QList<int> &regionOfCell);
+    // Adds houses of any other family
+    void addHouses(const QList<QList<int>> &houses);
+    // Rows, columns, regions, families in order of the enum and added houses (built once per change of the plan)
+    const QList<QList<int>> &houses() const;
+    // Killer cage (cages do not overlap), values of the cells are distinct and add up to sum
+    // Fails for cages with more cells than size or more than CageTable::MaxSets value sets (a row each)
+    bool addCage(const QList<int> &cells, int sum);
+
+    // Rows are candidates (r * size ^ 2 + c * size + v - 1), covering their cell and value in each of their houses
+    // Columns are cells, then values of houses with size cells (primary), then of smaller houses (secondary)
+    // Classic plans keep the cell, row, column and region columns at the same positions for every size
+    // Each cage adds a primary column and rows after the candidates, one for each value set it can take
+    // A value of a cage is a secondary column, taken by a candidate with the value or by each set without it
+    // Candidates with values outside all sets of their cage are left empty
+    Table compile() const;
+    // Column counts of compile()
+    int primaryColumns() const;
+    int secondaryColumns() const;
+    // Streams the rows of compile() one at a time (same order and columns) instead of holding them all
+    void compileRows(const std::function<void(const QList<int> &columns)> &addRow) const;
+
+private:
+    int n;
+    int families;
+    int boxRows;
+    int boxColumns;
+    QList<int> regions; // Region of each cell
+    QList<QList<int>> extraHouses;
+    QList<QPair<QList<int>, int>> cages; // Cells and sum
+    QList<QList<int>> allHouses; // Houses of all families
+
+    // Helpers
+    // Rebuilds houses of all families after regions, families or added houses change
+    void buildHouses();
+    // First column of each house (primary ones and cages first), sets column counts and first cage and cage value column
+    QList<int> layoutColumns(int &primary, int &secondary, int &cageColumn, int &cageValueColumn) const;
+    // Pairs of cells (row + dr, column + dc) apart (each pair once, offsets with dr > 0 or dr == 0 and dc > 0)
+    void appendPairs(QList<QList<int>> &pairs, const QList<QPair<int, int>> &offsets) const;
+};
@@ -2,75 +2,93 @@
 
 #include <QObject>
 
+#include <atomic>
+#include <functional>
+#include <random>
+
+#include "constraintplan.h"
+#include "exactcover.h"
+
 // Use QList::at() wherever possible, as it is guaranteed constant time (QList::operator[] is not)
 
 using GridRow = QList<int>;
 using Grid = QList<GridRow>;
 
-using SparseRow = QList<bool>;
-using SparseMatrix = QList<SparseRow>;
-
+// Sudoku front-end of the exact cover solver
 class DLX {
 public:
-    static const int MaxSearchDepth;
-
-    struct Node {
-        Node *head;
-
-        Node *up;
-        Node *down;
-        Node *left;
-        Node *right;
-
-        int size; // Column header
-        GridRow row = {0, 0, 0}; // Row identification for mapping solutions to sudoku grid [candidate, row, column]
-    };
+    using Stats = ExactCover::Stats;
+    using Zdd = ExactCover::Zdd;
 
     DLX(Grid sudoku);
-    ~DLX();
+    // Variant grid with rows streamed from its constraint plan (no table held, for large grids)
+    DLX(Grid sudoku, const ConstraintPlan &plan);
+    // Variant grid with the rows of its compiled constraint plan (compile once, reuse for every grid of the variant)
+    DLX(Grid sudoku, const ConstraintPlan::Table &table);
+    // Builds an empty grid of given size once, for reuse with coverCell()/uncoverCell() and count()
+    explicit DLX(int size);
+    DLX(int size, const ConstraintPlan::Table &table);
 
     bool solve();
     Grid solution();
 
+    // Reusable solver
+    // Covers a single given value (0-based row and column), fails if it conflicts with already covered values or is
+    // outside the grid (row or column beyond size, value outside 1 to size)
+    bool coverCell(int row, int column, int value);
+    // Uncovers the last covered given value (covers must be undone in reverse order)
+    void uncoverCell();
+    // Zero-copy API over caller-owned buffers of size ^ 2 cells (row-major, 0 for empty)
+    // Covers the givens on top of covered values, counts solutions up to the limit and writes the first one found,
+    // then uncovers the givens again (also when it throws), nothing is allocated once the solver is warmed up
+    // Solution may be null, it is left untouched without a solution (invalid or conflicting givens have none)
+    int count(const quint8 *givens, quint8 *solution, int limit = 2);
+    // Same as count() up to the first solution
+    bool solve(const quint8 *givens, quint8 *solution);
+    // Number of currently covered given values
+    int coveredCells() const;
+    // Removes a single candidate value from the matrix without covering its constraints, fails if already absent or
+    // outside the grid
+    bool excludeCell(int row, int column, int value);
+    // Restores the last excluded candidate value (exclusions and covers must be undone in reverse order)
+    void includeCell();
+    // Counts solutions up to the limit and maps the first one found, matrix is fully restored afterwards
+    int count(int limit = 2);
+    // Counts all solutions (saturates at 2^64 - 1) caching subproblems by their active columns (Knuth's DXZ)
+    // Optionally builds the ZDD of solutions (without covered values), at most maxEntries subproblems are cached
+    quint64 countMemo(Zdd *zdd = nullptr, int maxEntries = ExactCover::DefaultMemoEntries);
+    // Visits all solutions until the visitor returns false and returns their number, matrix is fully restored afterwards
+    int enumerate(const std::function<bool(const Grid &solution)> &visit);
+    // Randomizes the order of rows in every column, only valid with no covered values
+    void shuffleRows(std::mt19937 &rng);
+    // Search statistics of the last count()
+    Stats stats() const;
+    // Counts stop early once cancel is set (from any thread), null never stops
+    void setCancel(const std::atomic<bool> *cancel);
+    // Covers forced values (columns with a single row) until none are left, undone with uncoverCell()
+    // Naked singles only consider cell constraints, hidden singles also row, column and region constraints
+    int coverSingles(bool hidden);
+    // Candidates as "r1c2=3" by exact cover row (ZDD export)
+    QStringList rowNames() const;
+    // Bytes held by the exact cover matrix
+    qint64 memoryUsage() const;
+
 private:
     Grid sudoku;
 
     // Size and variations
     int size;
     int sizeSq;
-    int sizeSqrt;
-    int rows;
-    int columns;
-
-    // Links
-    Node *head;
-    QList<Node *> nodesToClean;
-    QList<Node *> solutions;
-    QList<Node *> origValues;
-
-    // Matrix
-    SparseMatrix matrix;
-
-    // DLX
-    // Remove a column from the matrix
-    void coverColumn(Node *column);
-    // Reverse of cover
-    void uncoverColumn(Node *column);
-    // Runs DLX search
-    bool search(int depth = 0);
 
-    // Exact Cover Builder
-    // Builds initial matrix containing all possibilities
-    void buildSparseMatrix();
-    // Builds a toroidal doubly linked list out of the sparse matrix
-    void buildLinkedList();
-    // Covers columns of values that are already present in the grid
-    void coverGridValues();
+    // Rows are candidates [value, row, column] in order of rowIndex()
+    // Columns are cell, row, column and region constraints (size ^ 2 each), followed by those of variants
+    ExactCover cover;
 
     // Helpers
-    // Chooses column with least number of nodes (deterministically) or the right one
-    // Choosing the column with the least number of nodes decreases the branching of the algorithm
-    Node *chooseNextColumn();
-    // Maps found solution back to 2D grid
-    void mapSolutionToGrid();
+    // Index of candidate value (1-based) at 0-based row and column
+    int rowIndex(int row, int column, int value) const;
+    // Whether a candidate lies within the grid
+    bool isCandidate(int row, int column, int value) const;
+    // Maps solution rows back to 2D grid
+    void mapSolutionToGrid(const QList<int> &rows);
 };
@@ -0,0 +1,325 @@
+#include "enumerator.h"
+
+#include <cmath>
+#include <algorithm>
+
+const int Enumerator::MaxGroupSize = 100000;
+
+namespace {
+    // Backtracking over row and column assignments (alternating), cells and labels are checked as soon as determined
+    struct AutomorphismSearch {
+        int size;
+        int sizeSqrt;
+        int limit;
+        QList<Transform> &group;
+
+        bool transpose = false;
+        QList<int> source; // Puzzle or its transpose, row-major
+        QList<int> target; // Puzzle, row-major
+        QList<int> rows; // Output row -> source row
+        QList<int> columns;
+        QList<bool> usedRows;
+        QList<bool> usedColumns;
+        QList<int> forward; // Source value -> output value (0 unassigned)
+        QList<int> backward;
+        QList<int> freeValues; // Values not present in puzzle (freely relabeled)
+        bool overflow = false;
+
+        AutomorphismSearch(const Grid &puzzle, int limit, QList<Transform> &group) : limit(limit), group(group) {
+            size = puzzle.size();
+            sizeSqrt = static_cast<int>(sqrt(size));
+
+            QList<bool> present;
+            for (int v = 0; v <= size; ++v) {
+                present.append(false);
+                forward.append(0);
+                backward.append(0);
+            }
+            for (int i = 0; i < size; ++i) {
+                rows.append(-1);
+                columns.append(-1);
+                usedRows.append(false);
+                usedColumns.append(false);
+                for (int j = 0; j < size; ++j) {
+                    int value = qMax(puzzle.at(i).at(j), 0);
+                    target.append(value);
+                    source.append(0);
+                    present[value] = true;
+                }
+            }
+            for (int v = 1; v <= size; ++v) {
+                if (!present.at(v)) {
+                    freeValues.append(v);
+                }
+            }
+        }
+
+        void run() {
+            for (int t = 0; t < 2 && !overflow; ++t) {
+                transpose = t == 1;
+                for (int i = 0; i < size; ++i) {
+                    for (int j = 0; j < size; ++j) {
+                        source[i * size + j] = transpose ? target.at(j * size + i) : target.at(i * size + j);
+                    }
+                }
+                search(0);
+            }
+        }
+
+        void search(int step) {
+            if (overflow) {
+                return;
+            }
+            if (step == 2 * size) {
+                addTransforms();
+                return;
+            }
+
+            // Rows and columns alternate, bands (stacks) are chosen by their first row (column)
+            bool isRow = step % 2 == 0;
+            int index = step / 2;
+            QList<int> &assignment = isRow ? rows : columns;
+            QList<bool> &used = isRow ? usedRows : usedColumns;
+
+            int first = 0;
+            int last = size;
+            if (index % sizeSqrt != 0) {
+                first = assignment.at(index - index % sizeSqrt) / sizeSqrt * sizeSqrt;
+                last = first + sizeSqrt;
+            }
+
+            QList<int> assigned;
+            for (int candidate = first; candidate < last; ++candidate) {
+                if (used.at(candidate)) {
+                    continue;
+                }
+                // Whole band (stack) must be unused when starting a new one
+                if (index % sizeSqrt == 0) {
+                    int band = candidate / sizeSqrt * sizeSqrt;
+                    bool free = true;
+                    for (int k = band; k < band + sizeSqrt; ++k) {
+                        free = free && !used.at(k);
+                    }
+                    if (!free) {
+                        continue;
+                    }
+                }
+
+                assignment[index] = candidate;
+                used[candidate] = true;
+
+                bool consistent = true;
+                int count = isRow ? index : index + 1; // Assigned columns (rows) crossing the new row (column)
+                for (int k = 0; k < count && consistent; ++k) {
+                    consistent = isRow ? check(index, k, assigned) : check(k, index, assigned);
+                }
+                if (consistent) {
+                    search(step + 1);
+                }
+
+                for (auto &value : assigned) {
+                    backward[forward.at(value)] = 0;
+                    forward[value] = 0;
+                }
+                assigned.clear();
+                used[candidate] = false;
+                assignment[index] = -1;
+            }
+        }
+
+        bool check(int i, int j, QList<int> &assigned) {
+            int from = source.at(rows.at(i) * size + columns.at(j));
+            int to = target.at(i * size + j);
+            if ((from == 0) != (to == 0)) {
+                return false;
+            }
+            if (from == 0) {
+                return true;
+            }
+            if (forward.at(from) == 0) {
+                if (backward.at(to) != 0) {
+                    return false;
+                }
+                forward[from] = to;
+                backward[to] = from;
+                assigned.append(from);
+                return true;
+            }
+            return forward.at(from) == to;
+        }
+
+        void addTransforms() {
+            Transform transform;
+            transform.transpose = transpose;
+            transform.rows = rows;
+            transform.columns = columns;
+            transform.labels = forward;
+
+            // Values not in the puzzle can be relabeled among themselves in any order
+            QList<int> order = freeValues;
+            do {
+                for (int k = 0; k < freeValues.size(); ++k) {
+                    transform.labels[freeValues.at(k)] = order.at(k);
+                }
+                if (group.size() >= limit) {
+                    overflow = true;
+                    return;
+                }
+                group.append(transform);
+            } while (std::next_permutation(order.begin(), order.end()));
+        }
+    };
+}
+
+Enumerator::Enumerator(int size) : size(size), dlx(size) {
+    sizeSq = size * size;
+    sizeSqrt = static_cast<int>(sqrt(size));
+}
+
+Enumerator::Result Enumerator::enumerate(const Grid &puzzle, const std::function<bool(const Grid &, quint64)> &visit) {
+    result = Result();
+
+    // Automorphisms as cell mappings, only the identity if there are too many to check
+    QList<Transform> transforms;
+    if (!automorphisms(puzzle, transforms)) {
+        result.symmetric = false;
+        transforms.clear();
+        Transform identity;
+        identity.labels.append(0);
+        for (int i = 0; i < size; ++i) {
+            identity.rows.append(i);
+            identity.columns.append(i);
+            identity.labels.append(i + 1);
+        }
+        transforms.append(identity);
+    }
+
+    group.clear();
+    for (auto &transform : transforms) {
+        Symmetry symmetry;
+        symmetry.labels = transform.labels;
+        for (int i = 0; i < size; ++i) {
+            for (int j = 0; j < size; ++j) {
+                symmetry.source.append(transform.transpose ? transform.columns.at(j) * size + transform.rows.at(i)
+                                                           : transform.rows.at(i) * size + transform.columns.at(j));
+            }
+        }
+        group.append(symmetry);
+    }
+    result.groupSize = group.size();
+
+    // Givens (conflicting givens have no solutions)
+    cells.clear();
+    bool valid = true;
+    for (int i = 0; i < size; ++i) {
+        for (int j = 0; j < size; ++j) {
+            int value = qMax(puzzle.at(i).at(j), 0);
+            cells.append(value);
+            if (value > 0 && valid) {
+                valid = dlx.coverCell(i, j, value);
+            }
+        }
+    }
+
+    // Symmetry breaking over the first band, without symmetries DLX enumerates everything directly
+    visitor = &visit;
+    if (valid) {
+        searchPrefix(0, group.size() > 1 ? sizeSqrt * size : 0);
+    }
+    visitor = nullptr;
+
+    while (dlx.coveredCells() > 0) {
+        dlx.uncoverCell();
+    }
+
+    return result;
+}
+
+bool Enumerator::automorphisms(const Grid &puzzle, QList<Transform> &group, int limit) {
+    group.clear();
+    AutomorphismSearch search(puzzle, limit, group);
+    search.run();
+    return !search.overflow;
+}
+
+void Enumerator::searchPrefix(int position, int prefixSize) {
+    if (position == prefixSize) {
+        dlx.enumerate([this](const Grid &solution) {
+            return visitSolution(solution);
+        });
+        return;
+    }
+
+    // Givens are already covered
+    if (cells.at(position) > 0) {
+        if (isPrefixLeader(position + 1)) {
+            searchPrefix(position + 1, prefixSize);
+        }
+        return;
+    }
+
+    for (int value = 1; value <= size && !result.stopped; ++value) {
+        if (dlx.coverCell(position / size, position % size, value)) {
+            cells[position] = value;
+            if (isPrefixLeader(position + 1)) {
+                searchPrefix(position + 1, prefixSize);
+            }
+            cells[position] = 0;
+            dlx.uncoverCell();
+        }
+    }
+}
+
+bool Enumerator::isPrefixLeader(int known) const {
+    for (auto &symmetry : group) {
+        // Compare while mapped cells come from known ones
+        for (int position = 0; position < known; ++position) {
+            int source = symmetry.source.at(position);
+            if (source >= known) {
+                break;
+            }
+
+            int mapped = symmetry.labels.at(cells.at(source));
+            if (mapped != cells.at(position)) {
+                if (mapped < cells.at(position)) {
+                    return false;
+                }
+                break;
+            }
+        }
+    }
+    return true;
+}
+
+bool Enumerator::visitSolution(const Grid &solution) {
+    // Leader is minimal in its orbit, automorphisms mapping it onto itself form its stabilizer
+    quint64 stabilizer = 0;
+    for (auto &symmetry : group) {
+        bool equal = true;
+        for (int position = 0; position < sizeSq && equal; ++position) {
+            int source = symmetry.source.at(position);
+            int mapped = symmetry.labels.at(solution.at(source / size).at(source % size));
+            int value = solution.at(position / size).at(position % size);
+            if (mapped != value) {
+                if (mapped < value) {
+                    return true;
+                }
+                equal = false;
+            }
+        }
+        if (equal) {
+            ++stabilizer;
+        }
+    }
+
+    // Orbit-stabilizer (Burnside): orbit size is group size over stabilizer size
+    quint64 orbitSize = static_cast<quint64>(group.size()) / stabilizer;
+    ++result.orbits;
+    result.solutions += orbitSize;
+
+    if (*visitor && !(*visitor)(solution, orbitSize)) {
+        result.stopped = true;
+        return false;
+    }
+    return true;
+}
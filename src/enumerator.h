@@ -0,0 +1,55 @@
+#pragma once
+
+#include <functional>
+
+#include "canonicalizer.h"
+#include "dlx.h"
+
+// Enumerates solutions up to symmetry of the puzzle (automorphisms in the sudoku symmetry group)
+// Only lexicographic leaders (minimal within their orbit) are visited, prefixes that cannot lead are pruned over the first band
+class Enumerator {
+public:
+    static const int MaxGroupSize;
+
+    struct Result {
+        quint64 orbits = 0; // Non-isomorphic solutions (leaders visited)
+        quint64 solutions = 0; // Exact total, sum of orbit sizes (group size / stabilizer size)
+        int groupSize = 1; // Automorphisms used for symmetry breaking
+        bool symmetric = true; // False if the group exceeded the limit and only the identity was used
+        bool stopped = false; // Visitor stopped enumeration
+    };
+
+    explicit Enumerator(int size);
+
+    // Visit receives each leader and the size of its orbit, returns false to stop
+    Result enumerate(const Grid &puzzle, const std::function<bool(const Grid &solution, quint64 orbitSize)> &visit = nullptr);
+
+    // All transforms mapping puzzle onto itself (including relabeling), false if there are more than the limit
+    static bool automorphisms(const Grid &puzzle, QList<Transform> &group, int limit = MaxGroupSize);
+
+private:
+    // Automorphism as cell mapping, output cell takes labels[cells[source[cell]]]
+    struct Symmetry {
+        QList<int> source;
+        QList<int> labels;
+    };
+
+    int size;
+    int sizeSq;
+    int sizeSqrt;
+
+    // Reusable solver (givens and prefix values are covered and uncovered in place)
+    DLX dlx;
+
+    QList<Symmetry> group;
+    QList<int> cells; // Current values in row-major order (0 unknown)
+    const std::function<bool(const Grid &, quint64)> *visitor;
+    Result result;
+
+    // Fills prefix cells in row-major order, then enumerates the rest with DLX
+    void searchPrefix(int position, int prefixSize);
+    // False if some automorphism maps the first known cells to a smaller prefix
+    bool isPrefixLeader(int known) const;
+    // Visits solution if it is the leader of its orbit, false to stop
+    bool visitSolution(const Grid &solution);
+};
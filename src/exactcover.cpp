@@ -0,0 +1,1198 @@
+#include "exactcover.h"
+
+#include "hugepages.h"
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+// Hints the node at a link into cache ahead of its use while links are walked (with EXACTCOVER_PREFETCH defined)
+// Expands to nothing otherwise, the link expression is not evaluated either
+#if defined(EXACTCOVER_PREFETCH) && (defined(__GNUC__) || defined(__clang__))
+#define PREFETCH_NODE(link) __builtin_prefetch(&at(link), 1)
+#else
+#define PREFETCH_NODE(link)
+#endif
+
+const int ExactCover::DefaultMemoEntries = 1 << 20;
+const int ExactCover::MemoColumnsPercent = 40;
+
+namespace {
+    std::atomic<bool> narrowLinksEnabled(true);
+
+    // Search nodes between polls of the cancel flag
+    const quint64 CancelInterval = 1024;
+
+    quint64 saturatingAdd(quint64 a, quint64 b) {
+        return a > std::numeric_limits<quint64>::max() - b ? std::numeric_limits<quint64>::max() : a + b;
+    }
+}
+
+quint64 ExactCover::Zdd::count() const {
+    QList<quint64> counts;
+    counts.reserve(nodes.size());
+    for (int i = 0; i < nodes.size(); ++i) {
+        // Terminals count as themselves
+        counts.append(i < 2 ? i : saturatingAdd(counts.at(nodes.at(i).lo), counts.at(nodes.at(i).hi)));
+    }
+    return counts.value(root, 0);
+}
+
+QString ExactCover::Zdd::toString(const QStringList &rowNames) const {
+    QString str;
+    for (int i = 2; i < nodes.size(); ++i) {
+        const ZddNode &node = nodes.at(i);
+        QString name = node.row < rowNames.size() ? rowNames.at(node.row) : QString::number(node.row);
+        str += QString::number(i) + ":(" + name + ")?" + QString::number(node.lo) + ":" + QString::number(node.hi) + "\n";
+    }
+    return str;
+}
+
+template <typename Link>
+class ExactCover::Arena {
+public:
+    // Links are byte offsets into nodes (heads, column headers, then rows in order), used as they are without scaling
+    // an index on every hop, node fields take the same width (16-byte nodes for 16-bit, 32-byte ones for 32-bit links)
+    using Value = typename std::make_signed<Link>::type;
+
+    struct Node {
+        Link head;
+
+        Link up;
+        Link down;
+        Link left;
+        Link right;
+
+        Value size = 0; // Column header
+        Value row = -1; // Row index
+        Value color = 0; // Color of secondary column, negative once purified (header: color it is purified with)
+    };
+
+    // Nodes reachable by links, and largest row index and color
+    static const int MaxNodes = static_cast<int>(std::numeric_limits<Link>::max() / sizeof(Node) + 1);
+    static const int MaxValue = std::numeric_limits<Value>::max();
+
+    Arena(int primaryColumns, int secondaryColumns, int rowsHint, int nodesHint);
+
+    // Whether a matrix of that many columns, rows and nodes fits links and row indices
+    static bool fits(int columns, int rows, int nodes);
+    // Whether the next row still fits (nodes, row index and colors)
+    bool fitsRow(const QList<int> &columnIndices, const QList<int> &colors) const;
+    // Same rows and multiplicities with links of another width, only valid before search
+    template <typename Other>
+    std::unique_ptr<Arena<Other>> convert() const;
+
+    void addRow(const QList<int> &columnIndices, const QList<int> &colors);
+    int rowCount() const;
+    int columnCount() const;
+    qint64 memoryUsage() const;
+    void setMultiplicity(int column, int lo, int hi);
+
+    bool coverRow(int row);
+    void uncoverRow();
+    int coveredRows() const;
+    bool excludeRow(int row);
+    void includeRow();
+    int count(int limit);
+    QList<int> solution() const;
+    quint64 countMemo(Zdd *zdd, int maxEntries);
+    int enumerate(const std::function<bool(const QList<int> &rows)> &visit);
+    void shuffleRows(std::mt19937 &rng);
+    Stats stats() const;
+    void setCancel(const std::atomic<bool> *cancel);
+    int coverSingles(int columnLimit);
+
+private:
+    static const int Head = 0; // Primary columns
+    static const int SecondaryHead = sizeof(Node); // Secondary columns (never chosen, may stay uncovered)
+    static const int FirstColumn = 2 * sizeof(Node);
+
+    int rows = 0;
+    int primaryColumns;
+    int columns;
+
+    // Links
+    // Huge page backed for large matrices (mode of HugePages at construction)
+    std::vector<Node, HugePageAllocator<Node>> nodes;
+    std::vector<int, HugePageAllocator<int>> rowNodes; // Link of the first node of each row (-1 for empty rows)
+    QList<int> solutions;
+    QList<int> covered;
+    QList<int> excluded;
+
+    // DLX
+    // Remove a column from the matrix
+    void coverColumn(int column);
+    // Reverse of cover
+    void uncoverColumn(int column);
+    // Covers column of an uncolored node, purifies column of a colored node (unless already purified)
+    void commit(int node);
+    // Reverse of commit
+    void uncommit(int node);
+    // Removes rows with other colors from the column of a colored node and marks those with the same color
+    void purify(int node);
+    // Reverse of purify
+    void unpurify(int node);
+    // Runs DLX search through all solutions up to the limit, backtracking fully (iteratively, rows on the stack lead
+    // back to their columns)
+    void searchCount(quint64 limit, int depth = 0);
+    // Takes rows above base off the search stack and restores their columns (search left by an exception)
+    void unwind(int base);
+    // Same with multiplicities, rows already tried for a column are left out of later branches (no repeated sets)
+    // Every level restores its selected, hidden and closed columns before an exception leaves it
+    void searchMultiplicity(quint64 limit, int depth = 0);
+    // Resets statistics and runs either search up to the limit, returns the number of solutions
+    quint64 search(quint64 limit);
+    // Solution of either search found, counts it and remembers or visits it
+    void countSolution();
+    quint64 solutionCount = 0;
+    QList<int> firstSolution;
+    QList<int> visitedSolution;
+    Stats searchStats;
+    const std::function<bool(const QList<int> &)> *visitor = nullptr;
+    bool searchStopped = false;
+    const std::atomic<bool> *cancel = nullptr;
+    // Stops the search once cancelled (polled every CancelInterval nodes)
+    void pollCancel();
+
+    // Multiplicities
+    // Column bounds and current coverage by column index (empty without multiplicities)
+    QList<int> lower;
+    QList<int> upper;
+    QList<int> coverage;
+    // Rows left out by all levels of the search (each row at most once, reserved before search)
+    std::vector<int> triedRows;
+    // Takes row out of all its columns and counts its columns, covers those that are full
+    void selectRow(int row);
+    // Reverse of select
+    void unselectRow(int row);
+    // Removes row from all its columns
+    void hideRow(int row);
+    // Reverse of hide
+    void unhideRow(int row);
+    // Column with least branches (rows, and closing it once its lower bound is met), -1 if one cannot be met
+    int chooseMultiplicityColumn();
+
+    // Memoized search
+    struct MemoEntry {
+        quint64 count;
+        int node; // In ZDD
+    };
+
+    // Counts solutions of the current subproblem and sets its ZDD node
+    quint64 searchMemo(int &node, int depth = 0);
+    // Sets bitset of active columns and returns their number
+    int activeColumns(QByteArray &key) const;
+    QHash<QByteArray, MemoEntry> *memo = nullptr;
+    int memoEntries = 0; // Maximum, later subproblems are not cached
+    Zdd *zdd = nullptr;
+
+    // Builder
+    // Creates heads and column headers of the toroidal doubly linked list
+    void buildColumns(int rowsHint, int nodesHint);
+
+    // Helpers
+    // Covers all columns of a row and remembers it as covered
+    void coverRowNodes(int row);
+    // Whether a row is still present and all its columns are active (and agree on color)
+    bool isAvailable(int row) const;
+    // Node at a link
+    Node &at(int link);
+    const Node &at(int link) const;
+    // Link of a column header and back
+    static int columnLink(int column);
+    static int columnIndex(int link);
+    // Chooses column with least number of nodes (deterministically) or the right one
+    // Choosing the column with the least number of nodes decreases the branching of the algorithm
+    int chooseNextColumn() const;
+    // Rows of covered values and current search stack
+    void collectSolution(QList<int> &rowIndices) const;
+};
+
+ExactCover::ExactCover(int primaryColumns, int secondaryColumns, const QList<int> &rowStarts, const QList<int> &columns,
+                       const QList<int> &colors)
+        : ExactCover(primaryColumns, secondaryColumns, rowStarts.size() - 1, columns.size()) {
+    for (int i = 0; i + 1 < rowStarts.size(); ++i) {
+        int start = rowStarts.at(i);
+        int length = rowStarts.at(i + 1) - start;
+        addRow(columns.mid(start, length), colors.isEmpty() ? colors : colors.mid(start, length));
+    }
+}
+
+ExactCover::ExactCover(int primaryColumns, int secondaryColumns, int rowsHint, int nodesHint) {
+    if (narrowLinksEnabled && Arena<quint16>::fits(primaryColumns + secondaryColumns, rowsHint, nodesHint)) {
+        narrow.reset(new Arena<quint16>(primaryColumns, secondaryColumns, rowsHint, nodesHint));
+    } else {
+        wide.reset(new Arena<int>(primaryColumns, secondaryColumns, rowsHint, nodesHint));
+    }
+}
+
+ExactCover::~ExactCover() {
+}
+
+void ExactCover::setNarrowLinks(bool enabled) {
+    narrowLinksEnabled = enabled;
+}
+
+bool ExactCover::narrowLinks() {
+    return narrowLinksEnabled;
+}
+
+void ExactCover::addRow(const QList<int> &columns, const QList<int> &colors) {
+    // Rows beyond the hints may outgrow narrow links
+    if (narrow && !narrow->fitsRow(columns, colors)) {
+        wide = narrow->convert<int>();
+        narrow.reset();
+    }
+    narrow ? narrow->addRow(columns, colors) : wide->addRow(columns, colors);
+}
+
+int ExactCover::rowCount() const {
+    return narrow ? narrow->rowCount() : wide->rowCount();
+}
+
+int ExactCover::columnCount() const {
+    return narrow ? narrow->columnCount() : wide->columnCount();
+}
+
+int ExactCover::linkBits() const {
+    return narrow ? 16 : 32;
+}
+
+qint64 ExactCover::memoryUsage() const {
+    return narrow ? narrow->memoryUsage() : wide->memoryUsage();
+}
+
+void ExactCover::setMultiplicity(int column, int lo, int hi) {
+    narrow ? narrow->setMultiplicity(column, lo, hi) : wide->setMultiplicity(column, lo, hi);
+}
+
+bool ExactCover::coverRow(int row) {
+    return narrow ? narrow->coverRow(row) : wide->coverRow(row);
+}
+
+void ExactCover::uncoverRow() {
+    narrow ? narrow->uncoverRow() : wide->uncoverRow();
+}
+
+int ExactCover::coveredRows() const {
+    return narrow ? narrow->coveredRows() : wide->coveredRows();
+}
+
+bool ExactCover::excludeRow(int row) {
+    return narrow ? narrow->excludeRow(row) : wide->excludeRow(row);
+}
+
+void ExactCover::includeRow() {
+    narrow ? narrow->includeRow() : wide->includeRow();
+}
+
+int ExactCover::count(int limit) {
+    return narrow ? narrow->count(limit) : wide->count(limit);
+}
+
+QList<int> ExactCover::solution() const {
+    return narrow ? narrow->solution() : wide->solution();
+}
+
+quint64 ExactCover::countMemo(Zdd *zdd, int maxEntries) {
+    return narrow ? narrow->countMemo(zdd, maxEntries) : wide->countMemo(zdd, maxEntries);
+}
+
+int ExactCover::enumerate(const std::function<bool(const QList<int> &rows)> &visit) {
+    return narrow ? narrow->enumerate(visit) : wide->enumerate(visit);
+}
+
+void ExactCover::shuffleRows(std::mt19937 &rng) {
+    narrow ? narrow->shuffleRows(rng) : wide->shuffleRows(rng);
+}
+
+ExactCover::Stats ExactCover::stats() const {
+    return narrow ? narrow->stats() : wide->stats();
+}
+
+void ExactCover::setCancel(const std::atomic<bool> *cancel) {
+    narrow ? narrow->setCancel(cancel) : wide->setCancel(cancel);
+}
+
+int ExactCover::coverSingles(int columnLimit) {
+    return narrow ? narrow->coverSingles(columnLimit) : wide->coverSingles(columnLimit);
+}
+
+// Arena
+template <typename Link>
+bool ExactCover::Arena<Link>::fits(int columns, int rows, int nodes) {
+    return static_cast<qint64>(FirstColumn / sizeof(Node)) + columns + std::max(nodes, 0) <= MaxNodes
+            && rows - 1 <= MaxValue;
+}
+
+template <typename Link>
+bool ExactCover::Arena<Link>::fitsRow(const QList<int> &columnIndices, const QList<int> &colors) const {
+    if (static_cast<qint64>(nodes.size()) + columnIndices.size() > MaxNodes || rows > MaxValue) {
+        return false;
+    }
+    for (int color : colors) {
+        if (color > MaxValue) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename Link>
+template <typename Other>
+std::unique_ptr<ExactCover::Arena<Other>> ExactCover::Arena<Link>::convert() const {
+    int headers = static_cast<int>(FirstColumn / sizeof(Node)) + columns;
+    std::unique_ptr<Arena<Other>> other(new Arena<Other>(primaryColumns, columns - primaryColumns, rows,
+                                                         static_cast<int>(nodes.size()) - headers));
+
+    QList<int> columnIndices;
+    QList<int> colors;
+    for (int first : rowNodes) {
+        columnIndices.clear();
+        colors.clear();
+        if (first >= 0) {
+            int node = first;
+            do {
+                columnIndices.append(columnIndex(at(node).head));
+                colors.append(at(node).color);
+                node = at(node).right;
+            } while (node != first);
+        }
+        other->addRow(columnIndices, colors);
+    }
+
+    for (int i = 0; i < lower.size(); ++i) {
+        other->setMultiplicity(i, lower.at(i), upper.at(i));
+    }
+    other->setCancel(cancel);
+    return other;
+}
+
+template <typename Link>
+ExactCover::Arena<Link>::Arena(int primaryColumns, int secondaryColumns, int rowsHint, int nodesHint)
+        : primaryColumns(primaryColumns), columns(primaryColumns + secondaryColumns) {
+    buildColumns(rowsHint, nodesHint);
+}
+
+template <typename Link>
+void ExactCover::Arena<Link>::addRow(const QList<int> &columnIndices, const QList<int> &colors) {
+    // Add a node for each column of the row and update column nodes accordingly
+    int first = -1;
+    for (int k = 0; k < columnIndices.size(); ++k) {
+        int top = columnLink(columnIndices.at(k));
+        int node = static_cast<int>(nodes.size() * sizeof(Node));
+        nodes.push_back(Node());
+        Node &added = nodes.back();
+        added.row = rows;
+        added.head = top;
+        if (columnIndices.at(k) >= primaryColumns) {
+            added.color = colors.value(k, 0);
+        }
+
+        // Link to all sides, first node in row links to itself
+        if (first < 0) {
+            first = node;
+            added.left = node;
+            added.right = node;
+        } else {
+            added.left = at(first).left;
+            added.right = first;
+            at(at(first).left).right = node;
+            at(first).left = node;
+        }
+
+        // Insert at the bottom of column
+        added.down = top;
+        added.up = at(top).up;
+        at(at(top).up).down = node;
+        at(top).up = node;
+        ++at(top).size;
+    }
+
+    rowNodes.push_back(first);
+    ++rows;
+}
+
+template <typename Link>
+int ExactCover::Arena<Link>::rowCount() const {
+    return rows;
+}
+
+template <typename Link>
+int ExactCover::Arena<Link>::columnCount() const {
+    return columns;
+}
+
+template <typename Link>
+qint64 ExactCover::Arena<Link>::memoryUsage() const {
+    return static_cast<qint64>(nodes.capacity() * sizeof(Node) + rowNodes.capacity() * sizeof(int));
+}
+
+template <typename Link>
+void ExactCover::Arena<Link>::setMultiplicity(int column, int lo, int hi) {
+    if (upper.isEmpty()) {
+        for (int i = 0; i < primaryColumns; ++i) {
+            lower.append(1);
+            upper.append(1);
+            coverage.append(0);
+        }
+    }
+    lower[column] = std::max(lo, 0);
+    upper[column] = std::max(hi, std::max(lo, 1));
+}
+
+// Reusable solver
+template <typename Link>
+bool ExactCover::Arena<Link>::coverRow(int row) {
+    int given = rowNodes.at(row);
+    if (given < 0 || !isAvailable(given)) {
+        return false;
+    }
+
+    coverRowNodes(given);
+    return true;
+}
+
+template <typename Link>
+void ExactCover::Arena<Link>::uncoverRow() {
+    int given = covered.takeLast();
+    if (!upper.isEmpty()) {
+        unselectRow(given);
+        return;
+    }
+
+    for (int node = at(given).left; node != given; node = at(node).left) {
+        uncommit(node);
+    }
+    uncommit(given);
+}
+
+template <typename Link>
+int ExactCover::Arena<Link>::coveredRows() const {
+    return covered.size();
+}
+
+template <typename Link>
+bool ExactCover::Arena<Link>::excludeRow(int row) {
+    int candidate = rowNodes.at(row);
+    if (candidate < 0 || !isAvailable(candidate)) {
+        return false;
+    }
+
+    // Remove row from all its columns (same as covering removes it)
+    hideRow(candidate);
+    excluded.append(candidate);
+
+    return true;
+}
+
+template <typename Link>
+void ExactCover::Arena<Link>::includeRow() {
+    unhideRow(excluded.takeLast());
+}
+
+template <typename Link>
+int ExactCover::Arena<Link>::count(int limit) {
+    return static_cast<int>(search(static_cast<quint64>(std::max(limit, 0))));
+}
+
+template <typename Link>
+QList<int> ExactCover::Arena<Link>::solution() const {
+    return firstSolution;
+}
+
+template <typename Link>
+quint64 ExactCover::Arena<Link>::countMemo(Zdd *zdd, int maxEntries) {
+    // Subproblems would also depend on coverage of columns, so every solution is visited and zdd is left untouched
+    if (!upper.isEmpty()) {
+        return search(std::numeric_limits<quint64>::max());
+    }
+
+    searchStats = Stats();
+    searchStopped = false;
+
+    QHash<QByteArray, MemoEntry> cache;
+    memo = &cache;
+    memoEntries = maxEntries;
+    this->zdd = zdd;
+    if (zdd) {
+        zdd->nodes = {{-1, 0, 0}, {-1, 1, 1}};
+    }
+
+    int node = 0;
+    quint64 count = searchMemo(node);
+    if (zdd) {
+        zdd->root = node;
+    }
+
+    memo = nullptr;
+    this->zdd = nullptr;
+    return count;
+}
+
+template <typename Link>
+int ExactCover::Arena<Link>::enumerate(const std::function<bool(const QList<int> &rows)> &visit) {
+    visitor = &visit;
+    quint64 solutions;
+    try {
+        solutions = search(std::numeric_limits<quint64>::max());
+    } catch (...) {
+        visitor = nullptr;
+        throw;
+    }
+    visitor = nullptr;
+
+    return static_cast<int>(std::min(solutions, static_cast<quint64>(std::numeric_limits<int>::max())));
+}
+
+template <typename Link>
+void ExactCover::Arena<Link>::shuffleRows(std::mt19937 &rng) {
+    QList<int> column;
+
+    for (int list : {Head, SecondaryHead}) {
+        for (int top = at(list).right; top != list; top = at(top).right) {
+            column.clear();
+            for (int node = at(top).down; node != top; node = at(node).down) {
+                column.append(node);
+            }
+            std::shuffle(column.begin(), column.end(), rng);
+
+            // Relink in new order
+            int up = top;
+            for (auto &node : column) {
+                at(node).up = up;
+                at(up).down = node;
+                up = node;
+            }
+            at(up).down = top;
+            at(top).up = up;
+        }
+    }
+}
+
+template <typename Link>
+ExactCover::Stats ExactCover::Arena<Link>::stats() const {
+    return searchStats;
+}
+
+template <typename Link>
+void ExactCover::Arena<Link>::setCancel(const std::atomic<bool> *cancel) {
+    this->cancel = cancel;
+}
+
+template <typename Link>
+int ExactCover::Arena<Link>::coverSingles(int columnLimit) {
+    int forced = 0;
+
+    bool found = true;
+    while (found) {
+        found = false;
+        for (int column = at(Head).right; column != Head; column = at(column).right) {
+            // Contradiction, nothing more can be forced
+            if (at(column).size == 0) {
+                return forced;
+            }
+
+            if (at(column).size == 1 && columnIndex(column) < columnLimit) {
+                coverRowNodes(at(column).down);
+                ++forced;
+                found = true;
+                break;
+            }
+        }
+    }
+
+    return forced;
+}
+
+// DLX
+template <typename Link>
+void ExactCover::Arena<Link>::coverColumn(int column) {
+    // Remove column
+    Node &top = at(column);
+    at(top.left).right = top.right;
+    at(top.right).left = top.left;
+
+    // Remove all rows in the column from other columns they are in
+    for (int node = top.down; node != column; node = at(node).down) {
+        PREFETCH_NODE(at(node).down);
+        for (int tmp = at(node).right; tmp != node; tmp = at(tmp).right) {
+            Node &other = at(tmp);
+            // Vertical neighbours of the next node (same row, usually in the same cache line)
+            PREFETCH_NODE(at(other.right).up);
+            PREFETCH_NODE(at(other.right).down);
+            at(other.up).down = other.down;
+            at(other.down).up = other.up;
+            --at(other.head).size;
+        }
+    }
+}
+
+template <typename Link>
+void ExactCover::Arena<Link>::uncoverColumn(int column) {
+    // Take advantage of the fact that every node that has been removed retains information about its neighbors
+
+    // Re-add all rows in the column from other columns they were in
+    Node &top = at(column);
+    for (int node = top.up; node != column; node = at(node).up) {
+        PREFETCH_NODE(at(node).up);
+        for (int tmp = at(node).left; tmp != node; tmp = at(tmp).left) {
+            Node &other = at(tmp);
+            PREFETCH_NODE(at(other.left).up);
+            PREFETCH_NODE(at(other.left).down);
+            ++at(other.head).size;
+            at(other.up).down = tmp;
+            at(other.down).up = tmp;
+        }
+    }
+
+    // Re-add column
+    at(top.left).right = column;
+    at(top.right).left = column;
+}
+
+template <typename Link>
+void ExactCover::Arena<Link>::commit(int node) {
+    if (at(node).color == 0) {
+        coverColumn(at(node).head);
+    } else if (at(node).color > 0) {
+        purify(node);
+    }
+}
+
+template <typename Link>
+void ExactCover::Arena<Link>::uncommit(int node) {
+    if (at(node).color == 0) {
+        uncoverColumn(at(node).head);
+    } else if (at(node).color > 0) {
+        unpurify(node);
+    }
+}
+
+template <typename Link>
+void ExactCover::Arena<Link>::purify(int node) {
+    int column = at(node).head;
+    int color = at(node).color;
+    at(column).color = color;
+
+    // Node itself keeps its color, so uncommit() knows to unpurify
+    for (int row = at(column).down; row != column; row = at(row).down) {
+        if (row == node) {
+            continue;
+        }
+
+        if (at(row).color == color) {
+            at(row).color = -1;
+        } else {
+            for (int tmp = at(row).right; tmp != row; tmp = at(tmp).right) {
+                Node &other = at(tmp);
+                at(other.up).down = other.down;
+                at(other.down).up = other.up;
+                --at(other.head).size;
+            }
+        }
+    }
+}
+
+template <typename Link>
+void ExactCover::Arena<Link>::unpurify(int node) {
+    int column = at(node).head;
+    int color = at(node).color;
+
+    for (int row = at(column).up; row != column; row = at(row).up) {
+        if (row == node) {
+            continue;
+        }
+
+        if (at(row).color < 0) {
+            at(row).color = color;
+        } else {
+            for (int tmp = at(row).left; tmp != row; tmp = at(tmp).left) {
+                Node &other = at(tmp);
+                ++at(other.head).size;
+                at(other.up).down = tmp;
+                at(other.down).up = tmp;
+            }
+        }
+    }
+
+    at(column).color = 0;
+}
+
+template <typename Link>
+void ExactCover::Arena<Link>::searchCount(quint64 limit, int depth) {
+    int base = solutions.size();
+    // Every row on the stack covers another primary column, pushing rows never allocates
+    solutions.reserve(base + primaryColumns);
+
+    while (true) {
+        ++searchStats.nodes;
+        pollCancel();
+        if (depth + solutions.size() - base > searchStats.maxDepth) {
+            searchStats.maxDepth = depth + solutions.size() - base;
+        }
+
+        // Leaf counts its solution, otherwise the chosen column is covered and tried from its first row
+        int column = -1;
+        int row = -1;
+        if (at(Head).right == Head) {
+            // Solution or visitor may throw, the matrix is restored first
+            try {
+                countSolution();
+            } catch (...) {
+                unwind(base);
+                throw;
+            }
+        } else {
+            column = chooseNextColumn();
+            if (at(column).size > 1) {
+                ++searchStats.branches;
+            }
+            coverColumn(column);
+            row = at(column).down;
+        }
+
+        // Backtrack until a column has a row left to try (or the search is done)
+        while (column < 0 || row == column || solutionCount >= limit || searchStopped) {
+            if (column >= 0) {
+                uncoverColumn(column);
+            }
+            if (solutions.size() == base) {
+                return;
+            }
+
+            row = solutions.takeLast();
+            for (int left = at(row).left; left != row; left = at(left).left) {
+                uncommit(left);
+            }
+            column = at(row).head;
+            row = at(row).down;
+        }
+
+        solutions.append(row);
+        for (int right = at(row).right; right != row; right = at(right).right) {
+            commit(right);
+        }
+    }
+}
+
+template <typename Link>
+void ExactCover::Arena<Link>::unwind(int base) {
+    while (solutions.size() > base) {
+        int row = solutions.takeLast();
+        for (int left = at(row).left; left != row; left = at(left).left) {
+            uncommit(left);
+        }
+        uncoverColumn(at(row).head);
+    }
+}
+
+template <typename Link>
+void ExactCover::Arena<Link>::searchMultiplicity(quint64 limit, int depth) {
+    ++searchStats.nodes;
+    pollCancel();
+    if (depth > searchStats.maxDepth) {
+        searchStats.maxDepth = depth;
+    }
+
+    // Every column is full or closed
+    if (at(Head).right == Head) {
+        countSolution();
+        return;
+    }
+
+    int column = chooseMultiplicityColumn();
+    if (column < 0) {
+        return;
+    }
+    int needed = lower.at(columnIndex(column)) - coverage.at(columnIndex(column));
+    if (at(column).size + (needed <= 0 ? 1 : 0) > 1) {
+        ++searchStats.branches;
+    }
+
+    // Branch on the first remaining row, then leave it out of the rest (each set of rows is found once)
+    size_t tried = triedRows.size();
+    int selected = -1;
+    bool closed = false;
+    try {
+        while (at(column).size > 0 && at(column).size >= needed && solutionCount < limit && !searchStopped) {
+            int row = at(column).down;
+            solutions.append(row);
+            selectRow(row);
+            selected = row;
+
+            searchMultiplicity(limit, depth + 1);
+
+            selected = -1;
+            unselectRow(row);
+            solutions.removeLast();
+            triedRows.push_back(row);
+            hideRow(row);
+        }
+
+        // Lower bound met, column may take no more rows
+        if (needed <= 0 && solutionCount < limit && !searchStopped) {
+            coverColumn(column);
+            closed = true;
+            searchMultiplicity(limit, depth + 1);
+            closed = false;
+            uncoverColumn(column);
+        }
+    } catch (...) {
+        // Deeper levels are already restored
+        if (selected >= 0) {
+            unselectRow(selected);
+            solutions.removeLast();
+        }
+        if (closed) {
+            uncoverColumn(column);
+        }
+        while (triedRows.size() > tried) {
+            unhideRow(triedRows.back());
+            triedRows.pop_back();
+        }
+        throw;
+    }
+
+    while (triedRows.size() > tried) {
+        unhideRow(triedRows.back());
+        triedRows.pop_back();
+    }
+}
+
+template <typename Link>
+quint64 ExactCover::Arena<Link>::search(quint64 limit) {
+    solutionCount = 0;
+    searchStats = Stats();
+    searchStopped = false;
+    firstSolution.erase(firstSolution.begin(), firstSolution.end());
+    if (upper.isEmpty()) {
+        searchCount(limit);
+    } else {
+        // Every row is selected or left out at most once on a path, pushing never allocates
+        solutions.reserve(solutions.size() + rows);
+        triedRows.reserve(static_cast<size_t>(rows));
+        searchMultiplicity(limit);
+    }
+    return solutionCount;
+}
+
+template <typename Link>
+void ExactCover::Arena<Link>::pollCancel() {
+    if (cancel && searchStats.nodes % CancelInterval == 0 && cancel->load(std::memory_order_relaxed)) {
+        searchStopped = true;
+    }
+}
+
+template <typename Link>
+void ExactCover::Arena<Link>::countSolution() {
+    // Count solution and remember the first one (solution stack is unwound afterwards)
+    if (solutionCount++ == 0) {
+        collectSolution(firstSolution);
+    }
+    if (visitor) {
+        collectSolution(visitedSolution);
+        if (!(*visitor)(visitedSolution)) {
+            searchStopped = true;
+        }
+    }
+}
+
+// Multiplicities
+template <typename Link>
+void ExactCover::Arena<Link>::selectRow(int row) {
+    hideRow(row);
+
+    int node = row;
+    do {
+        int column = columnIndex(at(node).head);
+        if (column < primaryColumns) {
+            if (++coverage[column] == upper.at(column)) {
+                coverColumn(at(node).head);
+            }
+        } else {
+            commit(node);
+        }
+        node = at(node).right;
+    } while (node != row);
+}
+
+template <typename Link>
+void ExactCover::Arena<Link>::unselectRow(int row) {
+    int node = row;
+    do {
+        node = at(node).left;
+        int column = columnIndex(at(node).head);
+        if (column < primaryColumns) {
+            if (coverage[column]-- == upper.at(column)) {
+                uncoverColumn(at(node).head);
+            }
+        } else {
+            uncommit(node);
+        }
+    } while (node != row);
+
+    unhideRow(row);
+}
+
+template <typename Link>
+void ExactCover::Arena<Link>::hideRow(int row) {
+    int node = row;
+    do {
+        Node &hidden = at(node);
+        at(hidden.up).down = hidden.down;
+        at(hidden.down).up = hidden.up;
+        --at(hidden.head).size;
+        node = hidden.right;
+    } while (node != row);
+}
+
+template <typename Link>
+void ExactCover::Arena<Link>::unhideRow(int row) {
+    int node = row;
+    do {
+        node = at(node).left;
+        Node &hidden = at(node);
+        ++at(hidden.head).size;
+        at(hidden.up).down = node;
+        at(hidden.down).up = node;
+    } while (node != row);
+}
+
+template <typename Link>
+int ExactCover::Arena<Link>::chooseMultiplicityColumn() {
+    int column = -1;
+    int columnBranches = 0;
+    for (int right = at(Head).right; right != Head; right = at(right).right) {
+        // Every row covers the column once at most
+        int needed = lower.at(columnIndex(right)) - coverage.at(columnIndex(right));
+        if (at(right).size < needed) {
+            return -1;
+        }
+
+        int branches = at(right).size + (needed <= 0 ? 1 : 0);
+        if (column < 0 || branches < columnBranches) {
+            column = right;
+            columnBranches = branches;
+        }
+    }
+    return column;
+}
+
+template <typename Link>
+quint64 ExactCover::Arena<Link>::searchMemo(int &node, int depth) {
+    ++searchStats.nodes;
+    pollCancel();
+    if (searchStopped) {
+        return 0;
+    }
+    if (depth > searchStats.maxDepth) {
+        searchStats.maxDepth = depth;
+    }
+
+    if (at(Head).right == Head) {
+        node = 1;
+        return 1;
+    }
+
+    // Remaining subproblem only depends on active columns (rows leave only with their columns)
+    QByteArray key;
+    int active = activeColumns(key);
+
+    // Small subproblems are cheaper to search again than to hash (unless they are needed in ZDD)
+    if (!zdd && active < columns * MemoColumnsPercent / 100) {
+        solutionCount = 0;
+        searchCount(std::numeric_limits<quint64>::max(), depth);
+        return solutionCount;
+    }
+
+    auto it = memo->constFind(key);
+    if (it != memo->constEnd()) {
+        ++searchStats.memoHits;
+        node = it.value().node;
+        return it.value().count;
+    }
+
+    // Fixed order (first column unless one is forced) lines up subproblems of different branches
+    int column = at(Head).right;
+    for (int right = at(column).right; right != Head && at(column).size > 0; right = at(right).right) {
+        if (at(right).size < 2 && at(right).size < at(column).size) {
+            column = right;
+        }
+    }
+    if (at(column).size > 1) {
+        ++searchStats.branches;
+    }
+    coverColumn(column);
+
+    quint64 count = 0;
+    QList<int> rows;
+    QList<int> his;
+    for (int row = at(column).down; row != column && !searchStopped; row = at(row).down) {
+        for (int right = at(row).right; right != row; right = at(right).right) {
+            commit(right);
+        }
+
+        int hi = 0;
+        count = saturatingAdd(count, searchMemo(hi, depth + 1));
+        if (zdd && hi != 0) {
+            rows.append(at(row).row);
+            his.append(hi);
+        }
+
+        for (int left = at(row).left; left != row; left = at(left).left) {
+            uncommit(left);
+        }
+    }
+
+    uncoverColumn(column);
+
+    // Chain of rows covering the column, built from the last one (rows without solutions are suppressed)
+    node = 0;
+    for (int i = rows.size() - 1; i >= 0; --i) {
+        zdd->nodes.append({rows.at(i), node, his.at(i)});
+        node = zdd->nodes.size() - 1;
+    }
+
+    // Counts of a cancelled search are partial
+    if (memo->size() < memoEntries && !searchStopped) {
+        memo->insert(key, {count, node});
+    }
+    return count;
+}
+
+template <typename Link>
+int ExactCover::Arena<Link>::activeColumns(QByteArray &key) const {
+    key.fill(0, (columns + 7) / 8);
+
+    int active = 0;
+    for (int list : {Head, SecondaryHead}) {
+        for (int column = at(list).right; column != list; column = at(column).right) {
+            int index = columnIndex(column);
+            key[index / 8] = static_cast<char>(key.at(index / 8) | (1 << (index % 8)));
+            ++active;
+        }
+    }
+
+    // Purified columns only admit rows of their color
+    for (int column = at(SecondaryHead).right; column != SecondaryHead; column = at(column).right) {
+        if (at(column).color != 0) {
+            int index = columnIndex(column);
+            int color = at(column).color;
+            key.append(reinterpret_cast<const char *>(&index), sizeof(int));
+            key.append(reinterpret_cast<const char *>(&color), sizeof(int));
+        }
+    }
+    return active;
+}
+
+// Builder
+template <typename Link>
+void ExactCover::Arena<Link>::buildColumns(int rowsHint, int nodesHint) {
+    nodes.reserve(FirstColumn / sizeof(Node) + static_cast<size_t>(columns + std::max(nodesHint, 0)));
+    rowNodes.reserve(static_cast<size_t>(std::max(rowsHint, 0)));
+
+    // Create heads
+    for (int list : {Head, SecondaryHead}) {
+        Node node;
+        node.head = list;
+        node.up = list;
+        node.down = list;
+        node.left = list;
+        node.right = list;
+        node.size = -1;
+        nodes.push_back(node);
+    }
+
+    // Create all column nodes, linked to the end of their list
+    for (int i = 0; i < columns; ++i) {
+        int list = i < primaryColumns ? Head : SecondaryHead;
+        int index = columnLink(i);
+        Node node;
+        node.head = index;
+        node.up = index;
+        node.down = index;
+        node.left = at(list).left;
+        node.right = list;
+        nodes.push_back(node);
+        at(at(list).left).right = index;
+        at(list).left = index;
+    }
+}
+
+// Helpers
+template <typename Link>
+void ExactCover::Arena<Link>::coverRowNodes(int row) {
+    // Remembered first, so a failing allocation leaves the matrix as it was
+    covered.append(row);
+    if (!upper.isEmpty()) {
+        selectRow(row);
+        return;
+    }
+
+    commit(row);
+    for (int node = at(row).right; node != row; node = at(node).right) {
+        commit(node);
+    }
+}
+
+template <typename Link>
+bool ExactCover::Arena<Link>::isAvailable(int row) const {
+    // Any column already covered means a conflicting row is selected, purified columns only keep rows of their color
+    int node = row;
+    do {
+        const Node &top = at(at(node).head);
+        if (at(top.left).right != at(node).head || at(at(node).up).down != node
+                || (top.color != 0 && at(node).color >= 0)) {
+            return false;
+        }
+        node = at(node).right;
+    } while (node != row);
+    return true;
+}
+
+template <typename Link>
+int ExactCover::Arena<Link>::chooseNextColumn() const {
+    int column = at(Head).right;
+    for (int right = at(column).right; right != Head; right = at(right).right) {
+        // Select if less values in current right column than in original right column
+        if (at(right).size < at(column).size) {
+            column = right;
+        }
+    }
+    return column;
+}
+
+template <typename Link>
+void ExactCover::Arena<Link>::collectSolution(QList<int> &rowIndices) const {
+    // Erased rather than cleared, keeps capacity (no allocation per solution once warmed up)
+    rowIndices.erase(rowIndices.begin(), rowIndices.end());
+    for (auto &row : covered) {
+        rowIndices.append(at(row).row);
+    }
+    for (auto &row : solutions) {
+        rowIndices.append(at(row).row);
+    }
+}
+
+template <typename Link>
+typename ExactCover::Arena<Link>::Node &ExactCover::Arena<Link>::at(int link) {
+    return *reinterpret_cast<Node *>(reinterpret_cast<char *>(nodes.data()) + static_cast<unsigned>(link));
+}
+
+template <typename Link>
+const typename ExactCover::Arena<Link>::Node &ExactCover::Arena<Link>::at(int link) const {
+    return *reinterpret_cast<const Node *>(reinterpret_cast<const char *>(nodes.data()) + static_cast<unsigned>(link));
+}
+
+template <typename Link>
+int ExactCover::Arena<Link>::columnLink(int column) {
+    return FirstColumn + column * static_cast<int>(sizeof(Node));
+}
+
+template <typename Link>
+int ExactCover::Arena<Link>::columnIndex(int link) {
+    return (link - FirstColumn) / static_cast<int>(sizeof(Node));
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <QObject>
+#include <QByteArray>
+#include <QHash>
+#include <QStringList>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <random>
+
+// Generic exact cover solver (Knuth's Algorithm X with dancing links, colors as in Algorithm C)
+// Rows are lists of column indices (CSR arrays), results are row indices
+// Primary columns [0, primary) are covered exactly once, secondary columns [primary, primary + secondary) at most once
+// Secondary columns may instead be shared by any number of rows that agree on their color
+// Primary columns may be given multiplicities (covered between lo and hi times, as in Knuth's Algorithm M)
+// Links are 16-bit for matrices of up to 4096 nodes (most 9x9 grids), 32-bit beyond
+class ExactCover {
+public:
+    static const int DefaultMemoEntries;
+    // Only subproblems with at least this share of active columns are cached when counting
+    static const int MemoColumnsPercent;
+
+    // Deterministic search statistics of the last count()
+    struct Stats {
+        quint64 nodes = 0; // Search tree nodes visited
+        quint64 branches = 0; // Visited nodes with a choice between multiple rows
+        int maxDepth = 0;
+        quint64 memoHits = 0; // Subproblems reused by countMemo()
+    };
+
+    // Zero-suppressed decision diagram of all solutions of the last countMemo()
+    // Each node either takes its row (hi) or not (lo), 0 and 1 are the false and true terminals
+    struct ZddNode {
+        int row;
+        int lo;
+        int hi;
+    };
+
+    struct Zdd {
+        QList<ZddNode> nodes; // Children always precede their parents
+        int root = 0;
+
+        // Number of solutions (saturates at 2^64 - 1)
+        quint64 count() const;
+        // One node per line as "id:(row)?lo:hi", root last, rows are named by index unless names are given
+        QString toString(const QStringList &rowNames = QStringList()) const;
+    };
+
+    // Row i holds columns[rowStarts[i]] to columns[rowStarts[i + 1] - 1] (rowStarts has one entry more than rows)
+    // Column indices of a row must be distinct, rows are tried in the given order
+    // Optional colors are parallel to columns, 0 is no color (colors of primary columns are ignored)
+    ExactCover(int primaryColumns, int secondaryColumns, const QList<int> &rowStarts, const QList<int> &columns,
+               const QList<int> &colors = QList<int>());
+    // Columns only, rows are streamed in with addRow() (hints reserve memory for all rows and their nodes at once)
+    // Hints also choose the link width, a matrix growing beyond narrow links switches to wide ones
+    ExactCover(int primaryColumns, int secondaryColumns, int rowsHint, int nodesHint);
+    ~ExactCover();
+
+    // Narrow links for matrices created from now on that fit them (enabled by default)
+    static void setNarrowLinks(bool enabled);
+    static bool narrowLinks();
+
+    // Appends the next row (same rules as CSR rows), only valid before search
+    void addRow(const QList<int> &columns, const QList<int> &colors = QList<int>());
+
+    int rowCount() const;
+    int columnCount() const;
+    // Bits per link (16 or 32)
+    int linkBits() const;
+    // Bytes held by links and row lookup
+    qint64 memoryUsage() const;
+    // Primary column is covered between lo and hi times (default exactly once), only valid with no covered rows
+    void setMultiplicity(int column, int lo, int hi);
+
+    // Reusable solver
+    // Selects a row before search, fails if it conflicts with already covered rows
+    bool coverRow(int row);
+    // Unselects the last covered row (covers must be undone in reverse order)
+    void uncoverRow();
+    // Number of currently covered rows
+    int coveredRows() const;
+    // Removes a single row without covering its columns, fails if already absent
+    bool excludeRow(int row);
+    // Restores the last excluded row (exclusions and covers must be undone in reverse order)
+    void includeRow();
+    // Counts solutions up to the limit and remembers the first one found, matrix is fully restored afterwards (also
+    // when remembering a solution throws)
+    int count(int limit = 2);
+    // Rows of the first solution found by the last count() (covered rows first)
+    QList<int> solution() const;
+    // Counts all solutions (saturates at 2^64 - 1) caching subproblems by their active columns (Knuth's DXZ)
+    // Optionally builds the ZDD of solutions (without covered rows), at most maxEntries subproblems are cached
+    // With multiplicities visits every solution without cache and leaves zdd untouched
+    quint64 countMemo(Zdd *zdd = nullptr, int maxEntries = DefaultMemoEntries);
+    // Visits all solutions (covered rows first) until the visitor returns false and returns their number (saturates at
+    // 2^31 - 1)
+    int enumerate(const std::function<bool(const QList<int> &rows)> &visit);
+    // Randomizes the order of rows in every column, only valid with no covered rows
+    void shuffleRows(std::mt19937 &rng);
+    // Search statistics of the last count()
+    Stats stats() const;
+    // Searches stop early once cancel is set (from any thread) and return what they counted so far, null never stops
+    void setCancel(const std::atomic<bool> *cancel);
+    // Covers forced rows (primary columns below the limit with a single row) until none are left, undone with uncoverRow()
+    // Only for exact covers without multiplicities
+    int coverSingles(int columnLimit);
+
+private:
+    // Matrix with links of one width (narrow 16-bit or wide 32-bit)
+    template <typename Link>
+    class Arena;
+
+    // Exactly one is set, narrow while the matrix fits its links
+    std::unique_ptr<Arena<quint16>> narrow;
+    std::unique_ptr<Arena<int>> wide;
+};
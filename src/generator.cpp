@@ -0,0 +1,166 @@
+#include "generator.h"
+
+#include <QPair>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+Generator::Generator(const Options &options, quint64 seed, quint32 stream) : options(options), dlx(options.size) {
+    std::seed_seq seq = {static_cast<quint32>(seed), static_cast<quint32>(seed >> 32), stream};
+    rng.seed(seq);
+
+    buildGroups();
+}
+
+Grid Generator::generate() {
+    int size = options.size;
+
+    // Fill random complete grid (randomized search through shuffled rows)
+    dlx.shuffleRows(rng);
+    dlx.count(1);
+    lastSolution = dlx.solution();
+
+    // Random removal order, first tested group is covered last (on top of the stack)
+    std::shuffle(groups.begin(), groups.end(), rng);
+    for (int i = groups.size() - 1; i >= 0; --i) {
+        coverCells(groups.at(i));
+    }
+
+    // Remove groups one at a time, keeping those that make the solution non-unique
+    // Covers can only be undone in reverse order, so kept groups are lifted off the stack for each test
+    QList<int> kept;
+    QList<bool> removed;
+    removed.reserve(size * size);
+    for (int i = 0; i < size * size; ++i) {
+        removed.append(false);
+    }
+
+    int clues = size * size;
+    for (auto &group : groups) {
+        if (options.targetClues > 0 && clues <= options.targetClues) {
+            break;
+        }
+
+        uncoverCells(kept.size() + group.size());
+        coverCells(kept);
+
+        if (dlx.count(2) == 1) {
+            clues -= group.size();
+            for (auto &cell : group) {
+                removed[cell] = true;
+            }
+        } else {
+            coverCells(group);
+            kept.append(group);
+        }
+    }
+
+    // Restore solver for next puzzle
+    uncoverCells(dlx.coveredCells());
+
+    Grid puzzle = lastSolution;
+    for (int i = 0; i < size * size; ++i) {
+        if (removed.at(i)) {
+            puzzle[i / size][i % size] = 0;
+        }
+    }
+
+    return puzzle;
+}
+
+Grid Generator::solution() const {
+    return lastSolution;
+}
+
+QList<Grid> Generator::generate(const Options &options, int count, int threads, quint64 seed) {
+    std::atomic<int> next(0);
+    std::vector<QList<Grid>> results(static_cast<size_t>(threads));
+    std::vector<std::thread> workers;
+
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            Generator generator(options, seed, static_cast<quint32>(t));
+            while (next++ < count) {
+                results[static_cast<size_t>(t)].append(generator.generate());
+            }
+        });
+    }
+
+    QList<Grid> puzzles;
+    puzzles.reserve(count);
+    for (size_t t = 0; t < workers.size(); ++t) {
+        workers[t].join();
+        puzzles.append(results[t]);
+    }
+
+    return puzzles;
+}
+
+void Generator::buildGroups() {
+    int size = options.size;
+    int last = size - 1;
+
+    QList<bool> grouped;
+    grouped.reserve(size * size);
+    for (int i = 0; i < size * size; ++i) {
+        grouped.append(false);
+    }
+
+    for (int i = 0; i < size; ++i) {
+        for (int j = 0; j < size; ++j) {
+            if (grouped.at(i * size + j)) {
+                continue;
+            }
+
+            // Orbit of the cell under chosen symmetry
+            QList<QPair<int, int>> orbit = {{i, j}};
+            switch (options.symmetry) {
+            case Symmetry::None:
+                break;
+            case Symmetry::Rotational:
+                orbit.append({last - i, last - j});
+                break;
+            case Symmetry::Quarter:
+                orbit.append({j, last - i});
+                orbit.append({last - i, last - j});
+                orbit.append({last - j, i});
+                break;
+            case Symmetry::Horizontal:
+                orbit.append({last - i, j});
+                break;
+            case Symmetry::Vertical:
+                orbit.append({i, last - j});
+                break;
+            case Symmetry::Diagonal:
+                orbit.append({j, i});
+                break;
+            }
+
+            QList<int> group;
+            for (auto &cell : orbit) {
+                int index = cell.first * size + cell.second;
+                if (!grouped.at(index)) {
+                    grouped[index] = true;
+                    group.append(index);
+                }
+            }
+            groups.append(group);
+        }
+    }
+}
+
+void Generator::coverCells(const QList<int> &cells) {
+    int size = options.size;
+    for (auto &cell : cells) {
+        int row = cell / size;
+        int column = cell % size;
+        dlx.coverCell(row, column, lastSolution.at(row).at(column));
+    }
+}
+
+void Generator::uncoverCells(int count) {
+    for (int i = 0; i < count; ++i) {
+        dlx.uncoverCell();
+    }
+}
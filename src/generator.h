@@ -0,0 +1,52 @@
+#pragma once
+
+#include <random>
+
+#include "dlx.h"
+
+class Generator {
+public:
+    // Symmetry of removed givens (cells in the same orbit are removed together)
+    enum class Symmetry {
+        None,
+        Rotational, // 180 degrees
+        Quarter, // 90 degrees
+        Horizontal, // Mirrored over horizontal axis
+        Vertical, // Mirrored over vertical axis
+        Diagonal // Mirrored over main diagonal
+    };
+
+    struct Options {
+        int size = 9;
+        int targetClues = 0; // Stop removing givens once reached (0 removes until minimal)
+        Symmetry symmetry = Symmetry::None;
+    };
+
+    // Each stream of the same seed gives an independent random sequence
+    Generator(const Options &options, quint64 seed, quint32 stream = 0);
+
+    // Generates a puzzle with unique solution
+    Grid generate();
+    // Solution of the last generated puzzle
+    Grid solution() const;
+
+    // Generates puzzles on multiple threads, each with its own generator and random stream
+    static QList<Grid> generate(const Options &options, int count, int threads, quint64 seed);
+
+private:
+    Options options;
+    std::mt19937 rng;
+
+    // Reusable solver (never rebuilt, givens are covered and uncovered in place)
+    DLX dlx;
+
+    Grid lastSolution;
+    QList<QList<int>> groups; // Cells (row * size + column) removed together
+
+    // Builds groups of cells according to symmetry
+    void buildGroups();
+    // Covers cells as givens with values from last solution
+    void coverCells(const QList<int> &cells);
+    // Uncovers number of last covered givens
+    void uncoverCells(int count);
+};
@@ -0,0 +1,50 @@
+#include "gridformat.h"
+
+#include <QStringList>
+
+#include <cmath>
+
+namespace GridFormat {
+    Grid fromString(const QString &text) {
+        // Values in reading order
+        QList<int> values;
+        QString simplified = QString(text).replace(',', ' ').simplified();
+        QStringList tokens = simplified.split(' ');
+        if (tokens.size() > 1) {
+            for (auto &token : tokens) {
+                bool ok = true;
+                int value = token == "." ? 0 : token.toInt(&ok);
+                if (!ok) {
+                    return Grid();
+                }
+                values.append(value);
+            }
+        } else {
+            for (auto &character : simplified) {
+                values.append(qMax(character.digitValue(), 0));
+            }
+        }
+
+        int size = static_cast<int>(std::lround(std::sqrt(values.size())));
+        if (size == 0 || size * size != values.size()) {
+            return Grid();
+        }
+
+        Grid sudoku;
+        sudoku.reserve(size);
+        for (int i = 0; i < size; ++i) {
+            sudoku.append(values.mid(i * size, size));
+        }
+        return sudoku;
+    }
+
+    QString toString(const Grid &sudoku) {
+        QStringList cells;
+        for (auto &row : sudoku) {
+            for (auto &value : row) {
+                cells.append(value < 1 ? "." : QString::number(value));
+            }
+        }
+        return cells.join(sudoku.size() > 9 ? " " : "");
+    }
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <QObject>
+
+#include "dlx.h"
+
+// Text forms of grids of any size
+namespace GridFormat {
+    // Dotted "53.2..4..." (one digit per cell, anything else empty) or numbers separated by whitespace or commas
+    // "5 3 . 2 ..." (0 or . empty), the latter for grids beyond 9x9 where values take multiple digits
+    // Empty grid unless there is a square number of cells (and all tokens are numbers)
+    Grid fromString(const QString &text);
+    // Dotted up to 9x9, separated by spaces from 16x16 on (empty cells as .)
+    QString toString(const Grid &sudoku);
+}
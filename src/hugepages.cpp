@@ -0,0 +1,65 @@
+#include "hugepages.h"
+
+#include <atomic>
+#include <cstdlib>
+
+#ifdef Q_OS_LINUX
+#include <sys/mman.h>
+#endif
+
+namespace HugePages {
+    namespace {
+        std::atomic<bool> hugePagesEnabled(true);
+
+#ifdef Q_OS_LINUX
+        // Mapped memory is used for whole huge pages
+        size_t mappedBytes(size_t bytes) {
+            return (bytes + PageSize - 1) / PageSize * PageSize;
+        }
+#endif
+    }
+
+    void setEnabled(bool enabled) {
+        hugePagesEnabled = enabled;
+    }
+
+    bool isEnabled() {
+        return hugePagesEnabled;
+    }
+
+    void *allocate(size_t bytes, bool huge) {
+#ifdef Q_OS_LINUX
+        if (huge && bytes >= PageSize) {
+            size_t length = mappedBytes(bytes);
+
+            // Reserved huge pages (vm.nr_hugepages) first, then ordinary pages merged by the kernel where it can
+            int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+            void *memory = mmap(nullptr, length, PROT_READ | PROT_WRITE, flags | MAP_HUGETLB, -1, 0);
+            if (memory == MAP_FAILED) {
+                memory = mmap(nullptr, length, PROT_READ | PROT_WRITE, flags, -1, 0);
+                if (memory == MAP_FAILED) {
+                    return nullptr;
+                }
+                madvise(memory, length, MADV_HUGEPAGE);
+            }
+            return memory;
+        }
+#else
+        Q_UNUSED(huge);
+#endif
+        return std::malloc(bytes);
+    }
+
+    void release(void *memory, size_t bytes, bool huge) {
+#ifdef Q_OS_LINUX
+        if (huge && bytes >= PageSize) {
+            munmap(memory, mappedBytes(bytes));
+            return;
+        }
+#else
+        Q_UNUSED(bytes);
+        Q_UNUSED(huge);
+#endif
+        std::free(memory);
+    }
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <QtGlobal>
+
+#include <cstddef>
+#include <new>
+
+// Memory for large arrays (node arena of big grids) backed by huge pages on Linux, fewer TLB misses on long link chains
+// Tries reserved huge pages (MAP_HUGETLB), then transparent huge pages (MADV_HUGEPAGE) and falls back to the heap
+// elsewhere, for small arrays (below one huge page) or with the mode disabled
+namespace HugePages {
+    static const size_t PageSize = 2 * 1024 * 1024;
+
+    // Mode for arrays allocated from now on (enabled by default)
+    void setEnabled(bool enabled);
+    bool isEnabled();
+
+    // Memory of at least bytes, huge page backed if asked for and possible
+    void *allocate(size_t bytes, bool huge);
+    // Releases memory from allocate() with the same arguments
+    void release(void *memory, size_t bytes, bool huge);
+}
+
+// Standard allocator over HugePages, remembers the mode it was created with
+template <typename T>
+class HugePageAllocator {
+public:
+    using value_type = T;
+
+    HugePageAllocator() : huge(HugePages::isEnabled()) {
+    }
+    template <typename U>
+    HugePageAllocator(const HugePageAllocator<U> &other) : huge(other.huge) {
+    }
+
+    T *allocate(size_t n) {
+        void *memory = HugePages::allocate(n * sizeof(T), huge);
+        if (!memory) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T *>(memory);
+    }
+    void deallocate(T *memory, size_t n) {
+        HugePages::release(memory, n * sizeof(T), huge);
+    }
+
+    bool operator==(const HugePageAllocator &other) const {
+        return huge == other.huge;
+    }
+    bool operator!=(const HugePageAllocator &other) const {
+        return huge != other.huge;
+    }
+
+    bool huge;
+};
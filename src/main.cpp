@@ -1,9 +1,58 @@
 #include "mainwindow.h"
+#include "benchmark.h"
+#include "hugepages.h"
+#include "solverdaemon.h"
+#include "solvestore.h"
 #include <QApplication>
 
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
 int main(int argc, char *argv[]) {
+    // Solver daemon on a local socket shared by local services (--daemon <name>, no UI or display needed)
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (strcmp(argv[i], "--daemon") == 0) {
+            QCoreApplication a(argc, argv);
+            if (a.arguments().contains("--no-huge-pages")) {
+                HugePages::setEnabled(false);
+            }
+
+            SolverDaemon daemon(std::max(1, static_cast<int>(std::thread::hardware_concurrency())));
+            if (!daemon.listen(argv[i + 1])) {
+                qCritical() << "Could not listen on" << argv[i + 1] << daemon.errorString();
+                return 1;
+            }
+            return a.exec();
+        }
+    }
+
     QApplication a(argc, argv);
-    MainWindow w;
+
+    // Large matrices on the heap only (--no-huge-pages)
+    if (a.arguments().contains("--no-huge-pages")) {
+        HugePages::setEnabled(false);
+    }
+
+    // Benchmarks only (no UI)
+    if (a.arguments().contains("--benchmark")) {
+        Benchmark::run();
+        return 0;
+    }
+
+    // Persistent solve results shared between instances (--store <path>)
+    QString storePath;
+    int storeArgument = a.arguments().indexOf("--store");
+    if (storeArgument >= 0 && storeArgument + 1 < a.arguments().size()) {
+        storePath = a.arguments().at(storeArgument + 1);
+    }
+
+    SolveStore store(storePath);
+    if (!storePath.isEmpty() && !store.open()) {
+        qWarning() << "Could not open solve store" << storePath;
+    }
+
+    MainWindow w(store.isOpen() ? &store : nullptr);
     w.show();
 
     return a.exec();
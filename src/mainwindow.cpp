@@ -1,13 +1,86 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
+#include "bitsetsolver.h"
+#include "enumerator.h"
+#include "gridformat.h"
+#include "minimizer.h"
+#include "multigrid.h"
+#include "rater.h"
+#include "solver.h"
+#include "solverdaemon.h"
 
 #include <QValidator>
 #include <QInputDialog>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QLocalSocket>
 
+#include <algorithm>
 #include <cmath>
 #include <chrono>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <thread>
+
+namespace {
+    template <typename T>
+    void append(QByteArray &data, T value) {
+        data.append(reinterpret_cast<const char *>(&value), sizeof(T));
+    }
+
+    template <typename T>
+    T read(const char *data) {
+        T value;
+        memcpy(&value, data, sizeof(T));
+        return value;
+    }
+
+    // Daemon frame (length, then payload)
+    QByteArray daemonFrame(const QByteArray &payload) {
+        QByteArray data;
+        append<quint32>(data, static_cast<quint32>(payload.size()));
+        return data + payload;
+    }
+
+    // Solver request of a grid (header only without one)
+    QByteArray daemonRequest(quint32 id, SolverPool::Type type, const Grid &puzzle = Grid()) {
+        QByteArray request;
+        append<quint32>(request, id);
+        append<quint8>(request, static_cast<quint8>(type));
+        append<quint8>(request, static_cast<quint8>(puzzle.size()));
+        append<quint16>(request, 0);
+        append<quint32>(request, 2);
+        for (auto &row : puzzle) {
+            for (auto &value : row) {
+                append<quint8>(request, static_cast<quint8>(value));
+            }
+        }
+        return request;
+    }
+
+    // Frames received until count arrived, the daemon closed the connection or the timeout passed
+    // Daemon and client share this thread, so events are processed while waiting
+    QList<QByteArray> readFrames(QLocalSocket &socket, int count, int timeout) {
+        QList<QByteArray> frames;
+        QByteArray input;
+        QElapsedTimer timer;
+        timer.start();
+        while (frames.size() < count && socket.state() == QLocalSocket::ConnectedState && timer.elapsed() < timeout) {
+            QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+            input.append(socket.readAll());
+            while (input.size() >= 4 && input.size() - 4 >= static_cast<int>(read<quint32>(input.constData()))) {
+                int length = static_cast<int>(read<quint32>(input.constData()));
+                frames.append(input.mid(4, length));
+                input.remove(0, 4 + length);
+            }
+        }
+        return frames;
+    }
+}
 
-MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent), ui(new Ui::MainWindow) {
+MainWindow::MainWindow(SolveStore *store, QWidget *parent) : QMainWindow(parent), ui(new Ui::MainWindow),
+    cache(SolveCache::DefaultMaxMemory, store) {
     ui->setupUi(this);
 
     // Tests
@@ -19,6 +92,10 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent), ui(new Ui::MainWi
 }
 
 MainWindow::~MainWindow() {
+    if (countThread.joinable()) {
+        countCancelled = true;
+        countThread.join();
+    }
     delete ui;
 }
 
@@ -124,17 +201,25 @@ void MainWindow::resetGrid() {
 
 bool MainWindow::solveGrid(double &bench) {
     // Convert input data to primitive data
-    // Instantiate DLX solver
-    DLX dlx(UIGridToGrid());
+    Grid sudoku = UIGridToGrid();
 
-    // Solve (convert problem to exact cover problem and solve with DLX)
+    // Solve (cached by canonical form up to cached size, otherwise convert problem to exact cover problem and solve
+    // with DLX)
     auto benchStart = std::chrono::high_resolution_clock::now();
-    bool solved = dlx.solve();
+    Grid solution;
+    bool solved;
+    if (sudoku.size() > SolveCache::MaxSize) {
+        solved = Solver::solve(sudoku, solution);
+    } else {
+        SolveCache::Result result = cache.solve(sudoku);
+        solved = result.verdict != SolveCache::Verdict::None;
+        solution = result.solution;
+    }
     auto benchEnd = std::chrono::high_resolution_clock::now();
 
     if (solved) {
         // Apply to UI
-        gridToUIGrid(dlx.solution());
+        gridToUIGrid(solution);
 
         bench = std::chrono::duration<double, std::milli>(benchEnd - benchStart).count();
     }
@@ -168,6 +253,20 @@ void MainWindow::runTests() {
         qInfo() << "Some tests FAILED or gave WRONG results!";
     }
     qInfo() << "Average time:" << benchSum / Tests::size() << "milliseconds";
+
+    SolveCache::Stats stats = cache.stats();
+    qInfo() << "Cache:" << stats.hits << "hits," << stats.misses << "misses (" + QString::number(stats.hitRate() * 100.0) + "% hit rate),"
+            << stats.entries << "entries in" << stats.memory << "/" << stats.maxMemory << "bytes,"
+            << stats.storeHits << "misses found in store";
+
+    runRatingTests();
+    runMinimizerTests();
+    runOrbitTests();
+    runCountTests();
+    runExactCoverTests();
+    runVariantTests();
+    runMultiGridTests();
+    runDaemonTests();
 }
 
 void MainWindow::runTest(const Tests::Test &test, double &benchSum, bool &allPassed) {
@@ -193,6 +292,468 @@ void MainWindow::runTest(const Tests::Test &test, double &benchSum, bool &allPas
     }
 }
 
+void MainWindow::runRatingTests() {
+    qInfo() << "Running Rating Tests:";
+
+    generateGrid(9);
+
+    Rater rater(9);
+    bool allPassed = true;
+    double previousMax = -1.0;
+    for (auto &titles : Tests::ratingOrder) {
+        double classMin = -1.0;
+        double classMax = -1.0;
+        for (auto &test : Tests::s9x9) {
+            if (titles.contains(test.title)) {
+                stringGridToUIGrid(test.input);
+                double score = rater.rate(UIGridToGrid()).score;
+                resetGrid();
+                qInfo() << "-" << test.title << "rated" << score;
+
+                classMin = classMin < 0.0 ? score : qMin(classMin, score);
+                classMax = qMax(classMax, score);
+            }
+        }
+
+        if (classMin <= previousMax) {
+            qWarning() << "O Wrong: rating order of" << titles.first();
+            allPassed = false;
+        }
+        previousMax = classMax;
+    }
+
+    if (allPassed) {
+        qInfo() << "Rating order PASSED!";
+    } else {
+        qInfo() << "Rating order WRONG!";
+    }
+}
+
+void MainWindow::runMinimizerTests() {
+    qInfo() << "Running Minimizer Tests:";
+
+    generateGrid(9);
+
+    // Minimal puzzle keeps givens and unique solution of the input, removing any of its givens makes the solution non-unique
+    auto isMinimal = [](const Grid &puzzle, const Grid &minimal, int &clues) {
+        Grid expected;
+        Grid solution;
+        if (Solver::count(puzzle, 2, &expected) != 1 || Solver::count(minimal, 2, &solution) != 1 || solution != expected) {
+            return false;
+        }
+
+        clues = 0;
+        for (int i = 0; i < minimal.size(); ++i) {
+            for (int j = 0; j < minimal.size(); ++j) {
+                int value = minimal.at(i).at(j);
+                if (value < 1) {
+                    continue;
+                }
+
+                Grid removed = minimal;
+                removed[i][j] = 0;
+                if (value != puzzle.at(i).at(j) || Solver::count(removed, 2) != 2) {
+                    return false;
+                }
+                ++clues;
+            }
+        }
+        return true;
+    };
+
+    Minimizer minimizer(9);
+    int threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    bool allPassed = true;
+    for (auto &test : Tests::s9x9) {
+        if (!Tests::minimizer.contains(test.title)) {
+            continue;
+        }
+
+        stringGridToUIGrid(test.input);
+        Grid puzzle = UIGridToGrid();
+        resetGrid();
+
+        // Row-major order on a reusable solver and best of random orders on all threads
+        auto benchStart = std::chrono::high_resolution_clock::now();
+        Grid minimal = minimizer.minimize(puzzle);
+        Grid sparsest = Minimizer::minimize(puzzle, Minimizer::DefaultOrders, threads, 0);
+        auto benchEnd = std::chrono::high_resolution_clock::now();
+        double bench = std::chrono::duration<double, std::milli>(benchEnd - benchStart).count();
+
+        int clues = 0;
+        int sparsestClues = 0;
+        if (isMinimal(puzzle, minimal, clues) && isMinimal(puzzle, sparsest, sparsestClues)) {
+            qInfo() << "- Passed:" << test.title << "(" + QString::number(clues) << "clues, best of"
+                    << Minimizer::DefaultOrders << "orders" << sparsestClues << "clues in" << bench << "milliseconds)";
+        } else {
+            qWarning() << "O Wrong:" << test.title << "(in" << bench << "milliseconds)";
+            allPassed = false;
+        }
+    }
+
+    if (allPassed) {
+        qInfo() << "Minimizer PASSED!";
+    } else {
+        qInfo() << "Minimizer WRONG!";
+    }
+}
+
+void MainWindow::runOrbitTests() {
+    qInfo() << "Running Orbit Tests:";
+
+    for (auto &test : Tests::orbits) {
+        int size = static_cast<int>(sqrt(test.input.size()));
+        generateGrid(size);
+        stringGridToUIGrid(test.input);
+
+        Grid puzzle = UIGridToGrid();
+        resetGrid();
+
+        Enumerator enumerator(size);
+        Enumerator::Result result = enumerator.enumerate(puzzle);
+
+        // Exact total also through ZDD of memoized search
+        DLX dlx(size);
+        for (int i = 0; i < size; ++i) {
+            for (int j = 0; j < size; ++j) {
+                if (puzzle.at(i).at(j) > 0) {
+                    dlx.coverCell(i, j, puzzle.at(i).at(j));
+                }
+            }
+        }
+        DLX::Zdd zdd;
+        dlx.countMemo(&zdd);
+
+        if (result.orbits == static_cast<quint64>(test.orbits) && result.solutions == static_cast<quint64>(test.solutions)
+                && zdd.count() == result.solutions && Solver::countAll(puzzle) == result.solutions) {
+            qInfo() << "- Passed:" << test.title << "(" + QString::number(result.orbits) << "orbits," << result.solutions
+                    << "solutions, group of" << result.groupSize << ")";
+        } else {
+            qWarning() << "O Wrong:" << test.title << "(" + QString::number(result.orbits) << "orbits," << result.solutions
+                       << "solutions, group of" << result.groupSize << ")";
+        }
+    }
+}
+
+void MainWindow::runCountTests() {
+    qInfo() << "Running Count Tests:";
+
+    for (auto &test : Tests::counts) {
+        int size = static_cast<int>(sqrt(test.input.size()));
+        generateGrid(size);
+        stringGridToUIGrid(test.input);
+
+        Grid puzzle = UIGridToGrid();
+        resetGrid();
+
+        auto benchStart = std::chrono::high_resolution_clock::now();
+        BandCounter::Count solutions = Solver::countAll(puzzle);
+        auto benchEnd = std::chrono::high_resolution_clock::now();
+        double bench = std::chrono::duration<double, std::milli>(benchEnd - benchStart).count();
+
+        // Plain DLX search visits every solution
+        DLX dlx(size);
+        for (int i = 0; i < size; ++i) {
+            for (int j = 0; j < size; ++j) {
+                if (puzzle.at(i).at(j) > 0) {
+                    dlx.coverCell(i, j, puzzle.at(i).at(j));
+                }
+            }
+        }
+        auto dlxStart = std::chrono::high_resolution_clock::now();
+        int dlxSolutions = dlx.count(std::numeric_limits<int>::max());
+        auto dlxEnd = std::chrono::high_resolution_clock::now();
+        double dlxBench = std::chrono::duration<double, std::milli>(dlxEnd - dlxStart).count();
+
+        if (solutions == test.solutions && solutions == static_cast<quint64>(dlxSolutions)) {
+            qInfo() << "- Passed:" << test.title << "(" + BandCounter::toString(solutions) << "solutions in" << bench
+                    << "milliseconds, DLX in" << dlxBench << "milliseconds)";
+        } else {
+            qWarning() << "O Wrong:" << test.title << "(" + BandCounter::toString(solutions) << "solutions, DLX"
+                       << dlxSolutions << ")";
+        }
+    }
+
+    for (auto &test : Tests::gridCounts) {
+        generateGrid(BandCounter::Size);
+        stringGridToUIGrid(test.input);
+
+        Grid puzzle = UIGridToGrid();
+        resetGrid();
+
+        auto benchStart = std::chrono::high_resolution_clock::now();
+        QString solutions = BandCounter::toString(Solver::countAll(puzzle));
+        auto benchEnd = std::chrono::high_resolution_clock::now();
+        double bench = std::chrono::duration<double, std::milli>(benchEnd - benchStart).count();
+
+        if (solutions == test.solutions) {
+            qInfo() << "- Passed:" << test.title << "(" + solutions << "solutions in" << bench << "milliseconds)";
+        } else {
+            qWarning() << "O Wrong:" << test.title << "(" + solutions << "solutions)";
+        }
+    }
+}
+
+void MainWindow::runExactCoverTests() {
+    qInfo() << "Running Exact Cover Tests:";
+
+    for (auto &test : Tests::exactCovers) {
+        QList<int> rowStarts = {0};
+        QList<int> columns;
+        QList<int> colors;
+        for (int i = 0; i < test.rows.size(); ++i) {
+            columns.append(test.rows.at(i));
+            colors.append(test.colors.value(i));
+            rowStarts.append(columns.size());
+        }
+
+        ExactCover cover(test.primaryColumns, test.secondaryColumns, rowStarts, columns, colors);
+        QList<int> lower;
+        QList<int> upper;
+        for (int i = 0; i < test.primaryColumns; ++i) {
+            lower.append(1);
+            upper.append(1);
+        }
+        for (auto &multiplicity : test.multiplicities) {
+            cover.setMultiplicity(multiplicity.at(0), multiplicity.at(1), multiplicity.at(2));
+            lower[multiplicity.at(0)] = multiplicity.at(1);
+            upper[multiplicity.at(0)] = multiplicity.at(2);
+        }
+        int solutions = cover.count(std::numeric_limits<int>::max());
+
+        // Every primary column is covered within its bounds by the first solution
+        QList<int> covered;
+        for (int i = 0; i < test.primaryColumns; ++i) {
+            covered.append(0);
+        }
+        for (auto &row : cover.solution()) {
+            for (auto &column : test.rows.at(row)) {
+                if (column < test.primaryColumns) {
+                    ++covered[column];
+                }
+            }
+        }
+
+        bool bounded = true;
+        for (int i = 0; i < test.primaryColumns; ++i) {
+            bounded = bounded && covered.at(i) >= lower.at(i) && covered.at(i) <= upper.at(i);
+        }
+
+        if (solutions == test.solutions && bounded) {
+            qInfo() << "- Passed:" << test.title << "(" + QString::number(solutions) << "solutions)";
+        } else {
+            qWarning() << "O Wrong:" << test.title << "(" + QString::number(solutions) << "solutions)";
+        }
+    }
+}
+
+void MainWindow::runVariantTests() {
+    qInfo() << "Running Variant Tests:";
+
+    for (auto &test : Tests::variants) {
+        ConstraintPlan plan(test.size, test.families);
+        if (!test.regions.isEmpty() && !plan.setRegions(test.regions)) {
+            qCritical() << "X Failed:" << test.title << "(invalid regions)";
+            continue;
+        }
+        for (auto &cage : test.cages) {
+            plan.addCage(cage.mid(1), cage.at(0));
+        }
+
+        DLX dlx(test.size, plan.compile());
+        int solutions = dlx.count(test.solutions < 0 ? 1 : std::numeric_limits<int>::max());
+
+        // First solution holds every value once in each house and adds up to the sum of each cage
+        Grid solution = dlx.solution();
+        bool valid = true;
+        for (auto &house : plan.houses()) {
+            QList<int> values;
+            for (auto &cell : house) {
+                int value = solution.at(cell / test.size).at(cell % test.size);
+                valid = valid && value > 0 && !values.contains(value);
+                values.append(value);
+            }
+        }
+        for (auto &cage : test.cages) {
+            int sum = 0;
+            for (auto &cell : cage.mid(1)) {
+                sum += solution.at(cell / test.size).at(cell % test.size);
+            }
+            valid = valid && sum == cage.at(0);
+        }
+
+        bool passed = test.solutions < 0 ? solutions == 1 && valid : solutions == test.solutions && (solutions == 0 || valid);
+
+        // Bitset solver (no cages) finds as many solutions
+        if (test.cages.isEmpty()) {
+            BitsetSolver bitset(plan);
+            passed = passed && bitset.count(test.solutions < 0 ? 1 : std::numeric_limits<int>::max()) == solutions;
+        }
+
+        if (passed) {
+            qInfo() << "- Passed:" << test.title << "(" + QString::number(solutions) << "solutions)";
+        } else {
+            qWarning() << "O Wrong:" << test.title << "(" + QString::number(solutions) << "solutions)";
+        }
+    }
+}
+
+void MainWindow::runMultiGridTests() {
+    qInfo() << "Running Multi-Grid Tests:";
+
+    generateGrid(9);
+    for (auto &test : Tests::samurai) {
+        QList<Grid> puzzles;
+        for (auto &input : test.inputs) {
+            resetGrid();
+            stringGridToUIGrid(input);
+            puzzles.append(UIGridToGrid());
+        }
+
+        // Whole board in one search, each grid mapped from it
+        MultiGrid multiGrid(9, MultiGrid::samuraiOrigins());
+        auto benchStart = std::chrono::high_resolution_clock::now();
+        bool passed = multiGrid.solve(puzzles) && multiGrid.count(2) == 1;
+        auto benchEnd = std::chrono::high_resolution_clock::now();
+        double bench = std::chrono::duration<double, std::milli>(benchEnd - benchStart).count();
+
+        for (int i = 0; i < multiGrid.gridCount() && passed; ++i) {
+            gridToUIGrid(multiGrid.solution(i));
+            passed = UIGridToStringGrid() == test.expectedResults.at(i);
+        }
+        resetGrid();
+
+        if (passed) {
+            qInfo() << "- Passed:" << test.title << "(in" << bench << "milliseconds)";
+        } else {
+            qWarning() << "O Wrong:" << test.title << "(in" << bench << "milliseconds)";
+        }
+    }
+}
+
+void MainWindow::runDaemonTests() {
+    qInfo() << "Running Daemon Tests:";
+
+    // Daemon of this process on its own socket name
+    SolverDaemon daemon(2);
+    QString name = "SudokuDLX-test-" + QString::number(QCoreApplication::applicationPid());
+    if (!daemon.listen(name)) {
+        qCritical() << "X Failed: Daemon (" + daemon.errorString() + ")";
+        return;
+    }
+
+    // Pipelined solve requests with an invalid one (too short) and a stats request written at once, answered in order
+    {
+        QLocalSocket client;
+        client.connectToServer(name);
+        client.waitForConnected(1000);
+
+        QByteArray frames;
+        QList<QString> expected;
+        for (int i = 0; i < Tests::s9x9.size(); ++i) {
+            frames += daemonFrame(daemonRequest(static_cast<quint32>(i), SolverPool::Solve,
+                                          GridFormat::fromString(Tests::s9x9.at(i).input)));
+            expected.append(Tests::s9x9.at(i).expectedResult);
+        }
+        quint32 invalidId = static_cast<quint32>(expected.size());
+        frames += daemonFrame(daemonRequest(invalidId, SolverPool::Solve).left(SolverPool::HeaderSize - 1));
+        frames += daemonFrame(daemonRequest(invalidId + 1, SolverPool::Stats));
+        client.write(frames);
+
+        QList<QByteArray> responses = readFrames(client, expected.size() + 2, 10000);
+        bool ordered = responses.size() == expected.size() + 2;
+        bool answered = ordered;
+        for (int i = 0; i < responses.size() && ordered; ++i) {
+            const QByteArray &response = responses.at(i);
+            ordered = response.size() >= SolverPool::ResponseHeaderSize
+                    && read<quint32>(response.constData()) == static_cast<quint32>(i);
+            if (!ordered || i >= expected.size()) {
+                continue;
+            }
+
+            // Solutions (4) and the solution, zeros without one
+            int status = static_cast<quint8>(response.at(5));
+            int solutions = response.size() == SolverPool::ResponseHeaderSize + 4 + 81
+                    ? static_cast<int>(read<quint32>(response.constData() + SolverPool::ResponseHeaderSize)) : -1;
+            QString solution;
+            for (int j = SolverPool::ResponseHeaderSize + 4; j < response.size(); ++j) {
+                solution += QString::number(static_cast<quint8>(response.at(j)));
+            }
+            bool noSolution = expected.at(i) == "none";
+            answered = answered && status == SolverPool::Ok && solutions == (noSolution ? 0 : 1)
+                    && (noSolution || expected.at(i) == "any" || solution == expected.at(i));
+        }
+
+        if (ordered && answered) {
+            qInfo() << "- Passed: Pipelined requests (" + QString::number(responses.size()) << "responses in order)";
+        } else {
+            qWarning() << "O Wrong: Pipelined requests (" + QString::number(responses.size()) << "responses,"
+                       << (ordered ? "in order)" : "out of order)");
+        }
+
+        // Invalid request is answered with its status, the connection stays open
+        bool invalid = ordered && static_cast<quint8>(responses.at(expected.size()).at(5)) == SolverPool::InvalidRequest;
+        if (invalid && client.state() == QLocalSocket::ConnectedState) {
+            qInfo() << "- Passed: Invalid request";
+        } else {
+            qWarning() << "O Wrong: Invalid request";
+        }
+
+        // Stats: requests (8), queued (4), in flight (4), most queued (4), reserved (4), batches (8), percentiles (4 * 8)
+        QByteArray stats = ordered ? responses.last() : QByteArray();
+        int statsSize = SolverPool::ResponseHeaderSize + 8 + 4 * 4 + 8 + 4 * 8;
+        quint64 requests = stats.size() == statsSize ? read<quint64>(stats.constData() + SolverPool::ResponseHeaderSize) : 0;
+        if (stats.size() == statsSize && static_cast<quint8>(stats.at(5)) == SolverPool::Ok
+                && requests == static_cast<quint64>(expected.size() + 2)) {
+            qInfo() << "- Passed: Stats request (" + QString::number(requests) << "requests)";
+        } else {
+            qWarning() << "O Wrong: Stats request (" + QString::number(requests) << "requests)";
+        }
+    }
+
+    // Oversized frame closes the connection without a response
+    {
+        QLocalSocket client;
+        client.connectToServer(name);
+        client.waitForConnected(1000);
+
+        QByteArray header;
+        append<quint32>(header, static_cast<quint32>(SolverDaemon::MaxFrameSize) + 1);
+        client.write(header);
+
+        QList<QByteArray> responses = readFrames(client, 1, 10000);
+        if (responses.isEmpty() && client.state() == QLocalSocket::UnconnectedState) {
+            qInfo() << "- Passed: Oversized frame";
+        } else {
+            qWarning() << "O Wrong: Oversized frame";
+        }
+    }
+
+    // Second daemon on the name of a running one fails, the running one keeps answering (count limit above the cap)
+    {
+        SolverDaemon second(1);
+        bool refused = !second.listen(name);
+
+        QLocalSocket client;
+        client.connectToServer(name);
+        client.waitForConnected(1000);
+
+        QByteArray request = daemonRequest(0, SolverPool::Count, GridFormat::fromString(Tests::s9x9.first().input));
+        quint32 limit = static_cast<quint32>(SolverPool::MaxCountLimit) + 1;
+        memcpy(request.data() + 8, &limit, sizeof(limit));
+        client.write(daemonFrame(request));
+
+        QList<QByteArray> responses = readFrames(client, 1, 10000);
+        bool invalid = responses.size() == 1 && responses.first().size() == SolverPool::ResponseHeaderSize
+                && static_cast<quint8>(responses.first().at(5)) == SolverPool::InvalidRequest;
+        if (refused && invalid) {
+            qInfo() << "- Passed: Name in use";
+        } else {
+            qWarning() << "O Wrong: Name in use (" + second.errorString() + ")";
+        }
+    }
+}
+
 // Converters
 Grid MainWindow::UIGridToGrid() const {
     Grid sudoku;
@@ -220,16 +781,7 @@ void MainWindow::gridToUIGrid(Grid sudoku) {
 }
 
 void MainWindow::stringGridToUIGrid(QString gridStr) {
-    int i = 0;
-    int j = 0;
-    for (auto &valueStr : gridStr) {
-        setCellValue(grid.at(i).at(j), valueStr.digitValue());
-
-        if (++j >= grid.size()) {
-            j = 0;
-            ++i;
-        }
-    }
+    gridToUIGrid(GridFormat::fromString(gridStr));
 }
 
 QString MainWindow::UIGridToStringGrid() {
@@ -288,10 +840,10 @@ void MainWindow::onCellTextEdited(const QString &text) {
 void MainWindow::on_spinBoxSize_valueChanged(int size) {
     // Set value by supported steps (varied)
     if (size < grid.size()) {
-        QMap<int, int> steps = { {25, 16}, {16, 9}, {9, 4} };
+        QMap<int, int> steps = { {64, 49}, {49, 36}, {36, 25}, {25, 16}, {16, 9}, {9, 4} };
         size = steps[size + 1];
     } else if (size > grid.size()) {
-        QMap<int, int> steps = { {4, 9}, {9, 16}, {16, 25} };
+        QMap<int, int> steps = { {4, 9}, {9, 16}, {16, 25}, {25, 36}, {36, 49}, {49, 64} };
         size = steps[size - 1];
     }
     ui->spinBoxSize->blockSignals(true);
@@ -310,21 +862,16 @@ void MainWindow::on_spinBoxSize_valueChanged(int size) {
 
 void MainWindow::on_pushButtonImport_clicked() {
     bool ok;
-    QString text = QInputDialog::getText(this, "Sudoku Import", "Input Sudoku problem in format: 53.2..4...", QLineEdit::Normal, nullptr, &ok);
+    QString text = QInputDialog::getText(this, "Sudoku Import", "Input Sudoku problem in format: 53.2..4... (or numbers separated by spaces: 5 3 . 2 . . 4 ...)", QLineEdit::Normal, nullptr, &ok);
     if (ok && !text.isEmpty()) {
-        bool generated = true;
-        if (text.size() != grid.size() * grid.size()) {
-            double sizeSqrt = sqrt(text.size());
-            double intpart;
-            if (modf(sizeSqrt, &intpart) == 0.0) {
-                generated = generateGrid(static_cast<int>(sqrt(text.size())));
-            } else {
-                generated = false;
-            }
+        Grid sudoku = GridFormat::fromString(text);
+        bool generated = !sudoku.isEmpty();
+        if (generated && sudoku.size() != grid.size()) {
+            generated = generateGrid(sudoku.size());
         }
 
         if (generated) {
-            stringGridToUIGrid(text);
+            gridToUIGrid(sudoku);
             ui->statusBar->showMessage("Imported!");
         } else {
             ui->statusBar->showMessage("Invalid grid size! Only NxN grids supported.");
@@ -340,12 +887,89 @@ void MainWindow::on_pushButtonSolve_clicked() {
 
     if (solved) {
         ui->statusBar->showMessage("Solved in " + QString::number(bench) + " milliseconds!");
-        qInfo() << "Solution:" << UIGridToStringGrid();
+        qInfo() << "Solution:" << GridFormat::toString(UIGridToGrid());
     } else {
         ui->statusBar->showMessage("No solution!");
     }
 }
 
+void MainWindow::on_pushButtonCount_clicked() {
+    // Counting already, sparse grids may take arbitrarily long
+    if (countThread.joinable()) {
+        countCancelled = true;
+        ui->statusBar->showMessage("Cancelling count...");
+        return;
+    }
+
+    Grid puzzle = UIGridToGrid();
+    countCancelled = false;
+    countFailed = false;
+    ui->pushButtonCount->setText("Cancel");
+    ui->statusBar->showMessage("Counting...");
+
+    countThread = std::thread([this, puzzle] {
+        auto benchStart = std::chrono::high_resolution_clock::now();
+        try {
+            countSolutions = Solver::countAll(puzzle, &countCancelled);
+        } catch (...) {
+            countFailed = true;
+        }
+        auto benchEnd = std::chrono::high_resolution_clock::now();
+        countBench = std::chrono::duration<double, std::milli>(benchEnd - benchStart).count();
+
+        QMetaObject::invokeMethod(this, "countFinished", Qt::QueuedConnection);
+    });
+}
+
+void MainWindow::countFinished() {
+    countThread.join();
+    ui->pushButtonCount->setText("Count");
+
+    if (countFailed) {
+        ui->statusBar->showMessage("Count failed!");
+        return;
+    }
+    if (countCancelled) {
+        ui->statusBar->showMessage("Count cancelled after " + QString::number(countBench) + " milliseconds!");
+        return;
+    }
+
+    // Count saturates at 2^64 - 1 beyond 9x9
+    QString count = BandCounter::toString(countSolutions);
+    if (countSolutions == std::numeric_limits<quint64>::max()) {
+        count.prepend("at least ");
+    }
+    ui->statusBar->showMessage("Counted " + count + " solutions in " + QString::number(countBench) + " milliseconds!");
+}
+
+void MainWindow::on_pushButtonMinimize_clicked() {
+    Grid puzzle = UIGridToGrid();
+    if (Solver::count(puzzle, 2) != 1) {
+        ui->statusBar->showMessage("No unique solution!");
+        return;
+    }
+
+    // Sparsest of random removal orders on all threads
+    int threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    auto benchStart = std::chrono::high_resolution_clock::now();
+    Grid minimal = Minimizer::minimize(puzzle, Minimizer::DefaultOrders, threads, std::random_device()());
+    auto benchEnd = std::chrono::high_resolution_clock::now();
+    double bench = std::chrono::duration<double, std::milli>(benchEnd - benchStart).count();
+
+    gridToUIGrid(minimal);
+
+    int clues = 0;
+    for (auto &row : minimal) {
+        for (auto &value : row) {
+            if (value > 0) {
+                ++clues;
+            }
+        }
+    }
+    ui->statusBar->showMessage("Minimized to " + QString::number(clues) + " clues in " + QString::number(bench) + " milliseconds!");
+    qInfo() << "Minimized:" << GridFormat::toString(minimal);
+}
+
 void MainWindow::on_pushButtonReset_clicked() {
     resetGrid();
 }
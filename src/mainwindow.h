@@ -5,7 +5,12 @@
 
 #include <QDebug>
 
+#include <atomic>
+#include <thread>
+
+#include "bandcounter.h"
 #include "dlx.h"
+#include "solvecache.h"
 #include "tests.h"
 
 using UIGridRow = QList<QLineEdit *>;
@@ -19,21 +24,38 @@ class MainWindow : public QMainWindow {
     Q_OBJECT
 
 public:
-    explicit MainWindow(QWidget *parent = nullptr);
+    // Solve results are optionally persisted in store (not owned)
+    explicit MainWindow(SolveStore *store = nullptr, QWidget *parent = nullptr);
     ~MainWindow();
 
 private:
     Ui::MainWindow *ui;
 
     UIGrid grid;
+    SolveCache cache;
+
+    // Count button counts on its own thread (the button cancels it meanwhile), the window waits for it on close
+    std::thread countThread;
+    std::atomic<bool> countCancelled{false};
+    BandCounter::Count countSolutions;
+    double countBench = 0.0;
+    bool countFailed = false;
 
     bool generateGrid(int size);
     void deleteGrid();
     void resetGrid();
-    // Solves current grid and saves benchmark in millseconds
+    // Solves current grid (through cache) and saves benchmark in millseconds
     bool solveGrid(double &bench);
     void runTests();
     void runTest(const Tests::Test &test, double &benchSum, bool &allPassed);
+    void runRatingTests();
+    void runMinimizerTests();
+    void runOrbitTests();
+    void runCountTests();
+    void runExactCoverTests();
+    void runVariantTests();
+    void runMultiGridTests();
+    void runDaemonTests();
 
     // Converters
     // Converts UI grid to int grid (DLX)
@@ -54,5 +76,9 @@ private slots:
     void on_spinBoxSize_valueChanged(int size);
     void on_pushButtonImport_clicked();
     void on_pushButtonSolve_clicked();
+    void on_pushButtonCount_clicked();
+    // Shows the result once the count thread is done (queued by it)
+    void countFinished();
+    void on_pushButtonMinimize_clicked();
     void on_pushButtonReset_clicked();
 };
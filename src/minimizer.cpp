@@ -0,0 +1,153 @@
+#include "minimizer.h"
+
+#include <atomic>
+#include <random>
+#include <thread>
+#include <vector>
+
+const int Minimizer::DefaultOrders = 16;
+
+Minimizer::Minimizer(int size) : size(size), dlx(size) {
+}
+
+Grid Minimizer::minimize(const Grid &puzzle) {
+    QList<int> order;
+    order.reserve(size * size);
+    for (int i = 0; i < size * size; ++i) {
+        order.append(i);
+    }
+    return minimize(puzzle, order);
+}
+
+Grid Minimizer::minimize(const Grid &puzzle, const QList<int> &order) {
+    // Tested givens in order, first tested is covered last (on top of the stack)
+    QList<int> tested;
+    QList<bool> ordered;
+    ordered.reserve(size * size);
+    for (int i = 0; i < size * size; ++i) {
+        ordered.append(false);
+    }
+    for (auto &cell : order) {
+        if (puzzle.at(cell / size).at(cell % size) > 0 && !ordered.at(cell)) {
+            ordered[cell] = true;
+            tested.append(cell);
+        }
+    }
+
+    // Givens outside of order are covered first and never removed
+    QList<int> cells;
+    for (int i = 0; i < size * size; ++i) {
+        if (puzzle.at(i / size).at(i % size) > 0 && !ordered.at(i)) {
+            cells.append(i);
+        }
+    }
+    for (int i = tested.size() - 1; i >= 0; --i) {
+        cells.append(tested.at(i));
+    }
+
+    Grid minimal = puzzle;
+    if (!coverCells(puzzle, cells) || dlx.count(2) != 1) {
+        uncoverCells(dlx.coveredCells());
+        return minimal;
+    }
+
+    // Covers can only be undone in reverse order, so kept givens are lifted off the stack for each test
+    // Removal is tested by excluding the given's value in its cell (any solution found means a second solution)
+    QList<int> kept;
+    for (auto &cell : tested) {
+        int row = cell / size;
+        int column = cell % size;
+        int value = puzzle.at(row).at(column);
+
+        uncoverCells(kept.size() + 1);
+        coverCells(puzzle, kept);
+
+        dlx.excludeCell(row, column, value);
+        bool unique = dlx.count(1) == 0;
+        dlx.includeCell();
+
+        if (unique) {
+            minimal[row][column] = 0;
+        } else {
+            dlx.coverCell(row, column, value);
+            kept.append(cell);
+        }
+    }
+
+    // Restore solver for next puzzle
+    uncoverCells(dlx.coveredCells());
+
+    return minimal;
+}
+
+Grid Minimizer::minimize(const Grid &puzzle, int orders, int threads, quint64 seed) {
+    int size = puzzle.size();
+
+    std::atomic<int> next(0);
+    std::vector<Grid> results(static_cast<size_t>(threads));
+    std::vector<int> clues(static_cast<size_t>(threads), size * size + 1);
+    std::vector<std::thread> workers;
+
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            std::seed_seq seq = {static_cast<quint32>(seed), static_cast<quint32>(seed >> 32), static_cast<quint32>(t)};
+            std::mt19937 rng(seq);
+
+            Minimizer minimizer(size);
+            QList<int> order;
+            for (int i = 0; i < size * size; ++i) {
+                order.append(i);
+            }
+
+            while (next++ < orders) {
+                std::shuffle(order.begin(), order.end(), rng);
+                Grid minimal = minimizer.minimize(puzzle, order);
+
+                int count = 0;
+                for (auto &row : minimal) {
+                    for (auto &value : row) {
+                        if (value > 0) {
+                            ++count;
+                        }
+                    }
+                }
+
+                if (count < clues[static_cast<size_t>(t)]) {
+                    clues[static_cast<size_t>(t)] = count;
+                    results[static_cast<size_t>(t)] = minimal;
+                }
+            }
+        });
+    }
+
+    // Sparsest result over all threads
+    Grid sparsest = puzzle;
+    int sparsestClues = size * size + 1;
+    for (size_t t = 0; t < workers.size(); ++t) {
+        workers[t].join();
+        if (clues[t] < sparsestClues) {
+            sparsestClues = clues[t];
+            sparsest = results[t];
+        }
+    }
+
+    return sparsest;
+}
+
+bool Minimizer::coverCells(const Grid &puzzle, const QList<int> &cells) {
+    for (auto &cell : cells) {
+        int row = cell / size;
+        int column = cell % size;
+        int value = puzzle.at(row).at(column);
+        if (value < 1 || value > size || !dlx.coverCell(row, column, value)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void Minimizer::uncoverCells(int count) {
+    for (int i = 0; i < count; ++i) {
+        dlx.uncoverCell();
+    }
+}
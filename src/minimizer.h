@@ -0,0 +1,32 @@
+#pragma once
+
+#include "dlx.h"
+
+// Removes redundant givens until removing any remaining one makes the solution non-unique
+class Minimizer {
+public:
+    // Random removal orders tried by the parallel minimize() from the UI
+    static const int DefaultOrders;
+
+    explicit Minimizer(int size);
+
+    // Tries removing givens in row-major order
+    Grid minimize(const Grid &puzzle);
+    // Tries removing givens in given order of cells (row * size + column), other givens are kept
+    // Puzzles without a unique solution (or with a value above size) are returned unchanged
+    Grid minimize(const Grid &puzzle, const QList<int> &order);
+
+    // Tries random removal orders on multiple threads and keeps the sparsest result
+    static Grid minimize(const Grid &puzzle, int orders, int threads, quint64 seed);
+
+private:
+    int size;
+
+    // Reusable solver (never rebuilt, givens are covered and uncovered in place)
+    DLX dlx;
+
+    // Covers givens of cells, fails on conflicting givens or values outside 1 to size
+    bool coverCells(const Grid &puzzle, const QList<int> &cells);
+    // Uncovers number of last covered givens
+    void uncoverCells(int count);
+};
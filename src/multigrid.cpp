@@ -0,0 +1,174 @@
+#include "multigrid.h"
+
+#include <QHash>
+
+#include <algorithm>
+
+MultiGrid::MultiGrid(int size, const QList<QPair<int, int>> &origins) : MultiGrid(size, buildLayout(size, origins)) {
+}
+
+MultiGrid::MultiGrid(int size, const Layout &layout) : n(size), layout(layout),
+        cover(layout.table.primaryColumns, layout.table.secondaryColumns, layout.table.rowStarts, layout.table.columns) {
+}
+
+QList<QPair<int, int>> MultiGrid::samuraiOrigins() {
+    return {qMakePair(0, 0), qMakePair(0, 12), qMakePair(6, 6), qMakePair(12, 0), qMakePair(12, 12)};
+}
+
+int MultiGrid::size() const {
+    return n;
+}
+
+int MultiGrid::gridCount() const {
+    return layout.boardCells.size();
+}
+
+int MultiGrid::cellCount() const {
+    return layout.cells;
+}
+
+bool MultiGrid::solve(const QList<Grid> &grids) {
+    // Cover values already present in the grids (shared cells only once)
+    QList<int> given;
+    for (int i = 0; i < layout.cells; ++i) {
+        given.append(0);
+    }
+
+    for (int grid = 0; grid < grids.size() && grid < gridCount(); ++grid) {
+        for (int i = 0; i < n; ++i) {
+            for (int j = 0; j < n; ++j) {
+                int value = grids.at(grid).at(i).at(j);
+                if (value <= 0) {
+                    continue;
+                }
+
+                int cell = layout.boardCells.at(grid).at(i * n + j);
+                if (value > n || (given.at(cell) != 0 && given.at(cell) != value)) {
+                    return false;
+                }
+                if (given.at(cell) == 0) {
+                    if (!coverCell(grid, i, j, value)) {
+                        return false;
+                    }
+                    given[cell] = value;
+                }
+            }
+        }
+    }
+
+    return count(1) > 0;
+}
+
+Grid MultiGrid::solution(int grid) const {
+    Grid sudoku;
+    for (int i = 0; i < n; ++i) {
+        GridRow row;
+        for (int j = 0; j < n; ++j) {
+            row.append(values.value(layout.boardCells.at(grid).at(i * n + j), 0));
+        }
+        sudoku.append(row);
+    }
+    return sudoku;
+}
+
+// Reusable solver
+bool MultiGrid::coverCell(int grid, int row, int column, int value) {
+    return cover.coverRow(layout.boardCells.at(grid).at(row * n + column) * n + value - 1);
+}
+
+void MultiGrid::uncoverCell() {
+    cover.uncoverRow();
+}
+
+int MultiGrid::count(int limit) {
+    int solutions = cover.count(limit);
+
+    values.clear();
+    if (solutions > 0) {
+        for (int i = 0; i < layout.cells; ++i) {
+            values.append(0);
+        }
+        for (auto &row : cover.solution()) {
+            values[row / n] = row % n + 1;
+        }
+    }
+    return solutions;
+}
+
+MultiGrid::Stats MultiGrid::stats() const {
+    return cover.stats();
+}
+
+// Builder
+MultiGrid::Layout MultiGrid::buildLayout(int size, const QList<QPair<int, int>> &origins) {
+    Layout layout;
+    ConstraintPlan plan(size);
+    QList<QList<int>> gridHouses = plan.houses();
+
+    // Board cells in row-major order of the board
+    int boardColumns = 0;
+    for (auto &origin : origins) {
+        boardColumns = std::max(boardColumns, origin.second + size);
+    }
+    QList<int> positions;
+    for (auto &origin : origins) {
+        for (int i = 0; i < size * size; ++i) {
+            positions.append((origin.first + i / size) * boardColumns + origin.second + i % size);
+        }
+    }
+    std::sort(positions.begin(), positions.end());
+    positions.erase(std::unique(positions.begin(), positions.end()), positions.end());
+    layout.cells = positions.size();
+
+    QHash<int, int> cellOfPosition;
+    for (int i = 0; i < positions.size(); ++i) {
+        cellOfPosition.insert(positions.at(i), i);
+    }
+
+    // Houses of all grids in board cells, each distinct house once
+    QList<QList<int>> houses;
+    for (auto &origin : origins) {
+        QList<int> boardCells;
+        for (int i = 0; i < size * size; ++i) {
+            boardCells.append(cellOfPosition.value((origin.first + i / size) * boardColumns + origin.second + i % size));
+        }
+        layout.boardCells.append(boardCells);
+
+        for (auto &gridHouse : gridHouses) {
+            QList<int> house;
+            for (auto &cell : gridHouse) {
+                house.append(boardCells.at(cell));
+            }
+            std::sort(house.begin(), house.end());
+            if (!houses.contains(house)) {
+                houses.append(house);
+            }
+        }
+    }
+
+    // Columns of each candidate in ascending order (cells, then houses in order)
+    QList<QList<int>> housesOfCell;
+    for (int i = 0; i < layout.cells; ++i) {
+        housesOfCell.append(QList<int>());
+    }
+    for (int i = 0; i < houses.size(); ++i) {
+        for (auto &cell : houses.at(i)) {
+            housesOfCell[cell].append(layout.cells + i * size);
+        }
+    }
+
+    ConstraintPlan::Table &table = layout.table;
+    table.primaryColumns = layout.cells + houses.size() * size;
+    table.rowStarts.reserve(layout.cells * size + 1);
+    table.rowStarts.append(0);
+    for (int cell = 0; cell < layout.cells; ++cell) {
+        for (int value = 0; value < size; ++value) {
+            table.columns.append(cell);
+            for (auto &house : housesOfCell.at(cell)) {
+                table.columns.append(house + value);
+            }
+            table.rowStarts.append(table.columns.size());
+        }
+    }
+    return layout;
+}
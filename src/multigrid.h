@@ -0,0 +1,59 @@
+#pragma once
+
+#include <QObject>
+#include <QPair>
+
+#include "dlx.h"
+
+// Overlapping grids of the same size (Samurai) as a single exact cover instance
+// Grids share the board cells they overlap in, houses covering the same cells (overlapping boxes) share columns
+class MultiGrid {
+public:
+    using Stats = ExactCover::Stats;
+
+    // Grids with their top-left cell at (row, column) of the board, boxes square (or as close to square as size allows)
+    MultiGrid(int size, const QList<QPair<int, int>> &origins);
+
+    // Five 9x9 grids, corner grids share a box with the center one
+    static QList<QPair<int, int>> samuraiOrigins();
+
+    int size() const;
+    int gridCount() const;
+    // Number of distinct board cells
+    int cellCount() const;
+
+    // Covers givens of all grids (0 for empty) and searches for a solution, fails on conflicting givens
+    bool solve(const QList<Grid> &grids);
+    // Solution of a single grid from the last count()
+    Grid solution(int grid) const;
+
+    // Reusable solver
+    // Covers a single given value of a grid (0-based row and column), shared cells are given in all their grids
+    bool coverCell(int grid, int row, int column, int value);
+    // Uncovers the last covered given value (covers must be undone in reverse order)
+    void uncoverCell();
+    // Counts solutions up to the limit and remembers the first one found, matrix is fully restored afterwards
+    int count(int limit = 2);
+    // Search statistics of the last count()
+    Stats stats() const;
+
+private:
+    struct Layout {
+        QList<QList<int>> boardCells; // Board cell of each grid cell (row-major) by grid
+        int cells = 0;
+        ConstraintPlan::Table table;
+    };
+
+    int n;
+    Layout layout;
+    QList<int> values; // Value of each board cell in the first solution
+
+    // Rows are candidates (board cell * size + value - 1), columns are board cells and values of distinct houses
+    ExactCover cover;
+
+    MultiGrid(int size, const Layout &layout);
+
+    // Builder
+    // Numbers board cells row-major, merges houses of different grids covering the same cells
+    static Layout buildLayout(int size, const QList<QPair<int, int>> &origins);
+};
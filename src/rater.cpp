@@ -0,0 +1,54 @@
+#include "rater.h"
+
+#include <cmath>
+
+Rater::Rater(int size) : size(size), dlx(size) {
+}
+
+Rater::Rating Rater::rate(const Grid &puzzle) {
+    Rating rating;
+
+    int empty = 0;
+    bool valid = true;
+    for (int i = 0; i < size && valid; ++i) {
+        for (int j = 0; j < size && valid; ++j) {
+            int value = puzzle.at(i).at(j);
+            if (value < 1) {
+                ++empty;
+            } else {
+                // Values above size have no candidate (as in DLX::solve())
+                valid = value <= size && dlx.coverCell(i, j, value);
+            }
+        }
+    }
+
+    if (valid) {
+        // Singles-only propagation pass
+        rating.nakedSingles = dlx.coverSingles(false);
+        rating.hiddenSingles = dlx.coverSingles(true);
+        for (int i = 0; i < rating.nakedSingles + rating.hiddenSingles; ++i) {
+            dlx.uncoverCell();
+        }
+
+        // Uniqueness search from givens only
+        rating.solutions = dlx.count(2);
+        rating.stats = dlx.stats();
+    }
+
+    // Restore solver for next puzzle
+    while (dlx.coveredCells() > 0) {
+        dlx.uncoverCell();
+    }
+
+    if (rating.solutions > 0 && empty > 0) {
+        rating.score = static_cast<double>(empty - rating.nakedSingles) / empty
+                + static_cast<double>(empty - rating.nakedSingles - rating.hiddenSingles) / empty
+                + log2(static_cast<double>(rating.stats.nodes + rating.stats.branches) / (rating.stats.maxDepth + 1));
+    }
+
+    return rating;
+}
+
+void Rater::setCancel(const std::atomic<bool> *cancel) {
+    dlx.setCancel(cancel);
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "dlx.h"
+
+// Rates difficulty from deterministic search statistics (wall-clock independent)
+class Rater {
+public:
+    struct Rating {
+        // Naked singles (0 - 1) + singles (0 - 1) + search tree size (log2, 0 when fully forced)
+        // Roughly: 0 naked singles, 1 hidden singles, 2 beyond singles, 5+ extensive guessing
+        double score = 0.0;
+        int solutions = 0; // Counted up to 2
+        int nakedSingles = 0; // Values forced by cell constraints only
+        int hiddenSingles = 0; // Values forced by row, column or region constraints after naked singles
+        DLX::Stats stats;
+    };
+
+    explicit Rater(int size);
+
+    // Puzzles with conflicting givens or values above size are rated unsolvable (no solutions, score 0)
+    Rating rate(const Grid &puzzle);
+    // Search stops early once cancel is set (from any thread), null never stops
+    void setCancel(const std::atomic<bool> *cancel);
+
+private:
+    int size;
+
+    // Reusable solver (never rebuilt, givens are covered and uncovered in place)
+    DLX dlx;
+};
@@ -0,0 +1,87 @@
+#include "sdlx.h"
+#include "dlx.h"
+
+#include <climits>
+#include <cstring>
+#include <new>
+
+// Reusable sudoku solver behind the C handle, no exception leaves the C functions
+struct sdlx_solver {
+    explicit sdlx_solver(int size) : size(size), cells(static_cast<size_t>(size) * static_cast<size_t>(size)),
+            dlx(size) {
+    }
+
+    int size;
+    size_t cells;
+    DLX dlx;
+};
+
+int sdlx_abi_version(void) {
+    return SDLX_ABI_VERSION;
+}
+
+sdlx_solver *sdlx_solver_new(int size) {
+    if (size < 1 || size > 64) {
+        return nullptr;
+    }
+
+    try {
+        return new sdlx_solver(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void sdlx_free(sdlx_solver *solver) {
+    delete solver;
+}
+
+int sdlx_size(const sdlx_solver *solver) {
+    return solver ? solver->size : SDLX_ERROR_ARGUMENT;
+}
+
+int sdlx_solve(sdlx_solver *solver, const uint8_t *givens, uint8_t *solution) {
+    if (!solution) {
+        return SDLX_ERROR_ARGUMENT;
+    }
+    return sdlx_count(solver, givens, 1, solution);
+}
+
+int sdlx_count(sdlx_solver *solver, const uint8_t *givens, int limit, uint8_t *solution) {
+    if (!solver || !givens || limit < 1) {
+        return SDLX_ERROR_ARGUMENT;
+    }
+
+    try {
+        int solutions = solver->dlx.count(givens, solution, limit);
+        if (solutions == 0 && solution) {
+            std::memset(solution, 0, solver->cells);
+        }
+        return solutions;
+    } catch (const std::bad_alloc &) {
+        return SDLX_ERROR_MEMORY;
+    } catch (...) {
+        return SDLX_ERROR_INTERNAL;
+    }
+}
+
+int sdlx_batch(sdlx_solver *solver, const uint8_t *givens, size_t count, int limit, uint8_t *solutions,
+               int *results) {
+    // Solved puzzles are returned as int
+    if (!solver || !givens || !results || limit < 1 || count > static_cast<size_t>(INT_MAX)) {
+        return SDLX_ERROR_ARGUMENT;
+    }
+
+    int solved = 0;
+    for (size_t i = 0; i < count; ++i) {
+        results[i] = sdlx_count(solver, givens + i * solver->cells, limit,
+                                solutions ? solutions + i * solver->cells : nullptr);
+        if (results[i] < 0) {
+            return results[i];
+        }
+        if (results[i] > 0) {
+            ++solved;
+        }
+    }
+    return solved;
+}
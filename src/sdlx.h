@@ -0,0 +1,74 @@
+#pragma once
+
+/* C interface of the sudoku solver for embedding in services written in other languages
+ * Grids are byte buffers of size * size cells in row-major order, 0 for an empty cell and 1 to size for a value
+ * No Qt or C++ types cross this interface, the library itself (libsdlx) still links QtCore
+ *
+ * Thread safety:
+ * - sdlx_solver_new() and sdlx_free() may be called from any thread at any time
+ * - A solver is not thread-safe, calls on the same solver must not overlap (one solver per thread, or a lock)
+ * - Different solvers may be used from different threads at the same time
+ * - A solver may move between threads as long as its calls do not overlap
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Functions exported by the shared library, everything else is hidden */
+#if defined(_WIN32)
+#  if defined(SDLX_LIBRARY)
+#    define SDLX_API __declspec(dllexport)
+#  else
+#    define SDLX_API __declspec(dllimport)
+#  endif
+#elif defined(__GNUC__) || defined(__clang__)
+#  define SDLX_API __attribute__((visibility("default")))
+#else
+#  define SDLX_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Incremented on incompatible changes of this interface */
+#define SDLX_ABI_VERSION 1
+
+/* Negative results */
+#define SDLX_ERROR_ARGUMENT -1 /* Null solver or buffer, limit below 1 or batch count above INT_MAX */
+#define SDLX_ERROR_MEMORY -2 /* Out of memory */
+#define SDLX_ERROR_INTERNAL -3 /* Any other failure inside the solver (no C++ exception crosses this interface) */
+
+/* Solver of one grid size, built once and reused across calls */
+typedef struct sdlx_solver sdlx_solver;
+
+/* SDLX_ABI_VERSION the library was built with */
+SDLX_API int sdlx_abi_version(void);
+
+/* Solver for grids of size x size (1 to 64, boxes square or as close to square as size allows)
+ * Returns NULL on invalid size or out of memory */
+SDLX_API sdlx_solver *sdlx_solver_new(int size);
+/* Releases a solver, NULL is ignored */
+SDLX_API void sdlx_free(sdlx_solver *solver);
+
+/* Grid size of a solver */
+SDLX_API int sdlx_size(const sdlx_solver *solver);
+
+/* Solves givens and writes the first solution found (zeros without one)
+ * Returns 1 if solved, 0 without a solution (including invalid or conflicting givens) or a negative error */
+SDLX_API int sdlx_solve(sdlx_solver *solver, const uint8_t *givens, uint8_t *solution);
+
+/* Counts solutions of givens up to limit (2 tells unique from multiple), solution may be NULL
+ * Returns the number of solutions or a negative error */
+SDLX_API int sdlx_count(sdlx_solver *solver, const uint8_t *givens, int limit, uint8_t *solution);
+
+/* Counts count puzzles (at most INT_MAX) back to back (givens and solutions hold one grid after another, solutions
+ * may be NULL)
+ * Writes the number of solutions of each puzzle to results (up to limit)
+ * Returns the number of puzzles with at least one solution or a negative error (results then incomplete) */
+SDLX_API int sdlx_batch(sdlx_solver *solver, const uint8_t *givens, size_t count, int limit, uint8_t *solutions,
+                        int *results);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,34 @@
+QT -= gui
+QT += core
+
+TARGET = sdlx
+TEMPLATE = lib
+
+# Only the C interface is exported (sdlx.h), solver classes stay internal
+DEFINES += SDLX_LIBRARY
+CONFIG += shared hide_symbols
+
+include(../common.pri)
+
+SOURCES += \
+    ../constraintplan.cpp \
+    ../dlx.cpp \
+    ../exactcover.cpp \
+    ../hugepages.cpp \
+    ../sdlx.cpp
+
+HEADERS += \
+    ../constraintplan.h \
+    ../dlx.h \
+    ../exactcover.h \
+    ../hugepages.h \
+    ../sdlx.h
+
+# Default rules for deployment (library and its C header)
+unix:!android {
+    target.path = /usr/local/lib
+    header.files = ../sdlx.h
+    header.path = /usr/local/include
+    INSTALLS += header
+}
+!isEmpty(target.path): INSTALLS += target
@@ -0,0 +1,155 @@
+#include "solvecache.h"
+#include "canonicalizer.h"
+#include "solver.h"
+#include "solvestore.h"
+#include "table4x4.h"
+
+const int SolveCache::DefaultMaxMemory = 64 * 1024 * 1024;
+const int SolveCache::MaxSize = 9;
+
+double SolveCache::Stats::hitRate() const {
+    quint64 total = hits + misses;
+    return total > 0 ? static_cast<double>(hits) / total : 0.0;
+}
+
+SolveCache::SolveCache(int maxMemory, SolveStore *store) : cache(maxMemory), store(store) {
+}
+
+SolveCache::Result SolveCache::solve(const Grid &sudoku) {
+    int size = sudoku.size();
+
+    // Values out of range (manual input is not validated) have no solution
+    for (auto &row : sudoku) {
+        for (auto &value : row) {
+            if (value > size) {
+                return Result();
+            }
+        }
+    }
+
+    // 4x4 table lookup is cheaper than canonicalization, nothing to cache (nor for grids above cached size)
+    if (size == Table4x4::Size || size > MaxSize) {
+        return solveDirect(sudoku);
+    }
+
+    // Canonicalize outside of lock, only the cache itself is shared
+    // Grids over the canonicalization budget (or with repeated values) are solved uncached
+    Canonicalizer canonicalizer(size);
+    Transform transform;
+    Grid canonical;
+    if (!canonicalizer.canonicalize(sudoku, canonical, &transform)) {
+        return solveDirect(sudoku);
+    }
+    QString key = Canonicalizer::toString(canonical);
+
+    Result result;
+    Entry entry;
+
+    mutex.lock();
+    Entry *cached = cache.object(key);
+    if (cached) {
+        ++hits;
+        entry = *cached;
+        result.hit = true;
+    } else {
+        ++misses;
+    }
+    mutex.unlock();
+
+    // Concurrent misses of the same puzzle both solve it, the last one stays cached
+    if (!result.hit) {
+        quint64 hash = Canonicalizer::hash(canonical);
+        bool stored = store && store->find(canonical, hash, entry.verdict, entry.solution);
+        if (!stored) {
+            entry = solveCanonical(canonical);
+            if (store) {
+                store->append(canonical, hash, entry.verdict, entry.solution);
+            }
+        }
+
+        int cost = static_cast<int>(sizeof(Entry)) + key.size() * static_cast<int>(sizeof(QChar)) + entry.solution.size();
+        QMutexLocker locker(&mutex);
+        if (stored) {
+            ++storeHits;
+        }
+        cache.insert(key, new Entry(entry), cost);
+    }
+
+    result.verdict = entry.verdict;
+    if (entry.verdict == Verdict::Multiple) {
+        // Only the verdict is cached, solution is the one DLX::solve() finds in this orientation
+        Solver::solve(sudoku, result.solution);
+    } else if (entry.verdict == Verdict::Unique) {
+        Grid solution;
+        solution.reserve(size);
+        for (int i = 0; i < size; ++i) {
+            GridRow row;
+            row.reserve(size);
+            for (int j = 0; j < size; ++j) {
+                row.append(entry.solution.at(i * size + j));
+            }
+            solution.append(row);
+        }
+
+        // Map back onto orientation and labels of the solved grid
+        result.solution = transform.inverse().apply(solution);
+    }
+
+    return result;
+}
+
+SolveCache::Stats SolveCache::stats() const {
+    QMutexLocker locker(&mutex);
+
+    Stats stats;
+    stats.hits = hits;
+    stats.misses = misses;
+    stats.storeHits = storeHits;
+    stats.entries = cache.count();
+    stats.memory = cache.totalCost();
+    stats.maxMemory = cache.maxCost();
+    return stats;
+}
+
+void SolveCache::clear() {
+    QMutexLocker locker(&mutex);
+
+    cache.clear();
+    hits = 0;
+    misses = 0;
+    storeHits = 0;
+}
+
+SolveCache::Result SolveCache::solveDirect(const Grid &sudoku) {
+    Result result;
+    int solutions = Solver::count(sudoku, 2, &result.solution);
+    result.verdict = solutions == 0 ? Verdict::None : (solutions == 1 ? Verdict::Unique : Verdict::Multiple);
+    return result;
+}
+
+SolveCache::Entry SolveCache::solveCanonical(const Grid &canonical) {
+    int size = canonical.size();
+
+    Entry entry;
+
+    Grid solution;
+    int solutions = Solver::count(canonical, 2, &solution);
+    if (solutions == 0) {
+        return entry;
+    }
+
+    if (solutions > 1) {
+        entry.verdict = Verdict::Multiple;
+        return entry;
+    }
+
+    entry.verdict = Verdict::Unique;
+    entry.solution.reserve(size * size);
+    for (auto &row : solution) {
+        for (auto &value : row) {
+            entry.solution.append(static_cast<char>(value));
+        }
+    }
+
+    return entry;
+}
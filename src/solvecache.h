@@ -0,0 +1,69 @@
+#pragma once
+
+#include <QByteArray>
+#include <QCache>
+#include <QMutex>
+
+#include "dlx.h"
+
+class SolveStore;
+
+// Concurrency-safe LRU cache of solve results in front of DLX::solve()
+// Keyed by canonical form of the givens, so symmetric variants of a cached puzzle are hits as well
+class SolveCache {
+public:
+    static const int DefaultMaxMemory;
+    // Larger grids are solved directly, canonicalizing them costs more than most solves
+    static const int MaxSize;
+
+    enum class Verdict {
+        Unique,
+        Multiple, // Only the verdict is cached
+        None
+    };
+
+    struct Result {
+        Verdict verdict = Verdict::None;
+        Grid solution; // In orientation of the solved grid (as DLX::solve() with multiple), empty with no solution
+        bool hit = false;
+    };
+
+    struct Stats {
+        quint64 hits = 0;
+        quint64 misses = 0;
+        quint64 storeHits = 0; // Misses answered by the persistent store
+        int entries = 0;
+        int memory = 0; // Estimated bytes used by entries
+        int maxMemory = 0;
+
+        double hitRate() const;
+    };
+
+    // Least recently used entries are evicted once estimated memory exceeds the limit (bytes)
+    // Misses are looked up in and new results appended to the optional persistent store (not owned)
+    explicit SolveCache(int maxMemory = DefaultMaxMemory, SolveStore *store = nullptr);
+
+    Result solve(const Grid &sudoku);
+
+    Stats stats() const;
+    void clear();
+
+private:
+    // Result in canonical orientation
+    struct Entry {
+        Verdict verdict = Verdict::None;
+        QByteArray solution; // One value per cell, row by row (unique solutions only)
+    };
+
+    mutable QMutex mutex;
+    QCache<QString, Entry> cache;
+    SolveStore *store;
+    quint64 hits = 0;
+    quint64 misses = 0;
+    quint64 storeHits = 0;
+
+    // Solves grid uncached and counts solutions up to 2
+    static Result solveDirect(const Grid &sudoku);
+    // Solves canonical grid and counts solutions up to 2
+    static Entry solveCanonical(const Grid &canonical);
+};
@@ -0,0 +1,73 @@
+#include "solver.h"
+#include "table4x4.h"
+
+#include <limits>
+
+namespace Solver {
+    bool solve(const Grid &sudoku, Grid &solution) {
+        if (sudoku.size() == Table4x4::Size) {
+            return Table4x4::solve(sudoku, solution);
+        }
+
+        DLX dlx(sudoku);
+        bool solved = dlx.solve();
+        if (solved) {
+            solution = dlx.solution();
+        }
+        return solved;
+    }
+
+    int count(const Grid &sudoku, int limit, Grid *solution) {
+        int size = sudoku.size();
+        if (size == Table4x4::Size) {
+            return Table4x4::count(sudoku, limit, solution);
+        }
+
+        // Conflicting or out of range givens have no solution
+        DLX dlx(size);
+        for (int i = 0; i < size; ++i) {
+            for (int j = 0; j < size; ++j) {
+                int value = sudoku.at(i).at(j);
+                if (value > size || (value > 0 && !dlx.coverCell(i, j, value))) {
+                    return 0;
+                }
+            }
+        }
+
+        int solutions = dlx.count(limit);
+        if (solutions > 0 && solution) {
+            *solution = dlx.solution();
+        }
+        return solutions;
+    }
+
+    BandCounter::Count countAll(const Grid &sudoku, const std::atomic<bool> *cancel) {
+        int size = sudoku.size();
+        if (size == Table4x4::Size) {
+            return static_cast<quint64>(Table4x4::count(sudoku, Table4x4::GridCount));
+        }
+
+        DLX dlx(size);
+        for (int i = 0; i < size; ++i) {
+            for (int j = 0; j < size; ++j) {
+                int value = sudoku.at(i).at(j);
+                if (value > size || (value > 0 && !dlx.coverCell(i, j, value))) {
+                    return 0;
+                }
+            }
+        }
+
+        dlx.setCancel(cancel);
+
+        // Caching pays off once many subproblems repeat, with few givens (9x9 bands repeat even more)
+        if (dlx.coveredCells() * UnderConstrainedRatio < size * size) {
+            if (size == BandCounter::Size) {
+                BandCounter counter;
+                counter.setCancel(cancel);
+                return counter.count(sudoku);
+            }
+            return dlx.countMemo();
+        }
+        return static_cast<quint64>(dlx.count(std::numeric_limits<int>::max()));
+    }
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "bandcounter.h"
+#include "dlx.h"
+
+// Selects solver by grid size (table lookup for 4x4, DLX otherwise)
+namespace Solver {
+    // Grids with fewer givens than one in UnderConstrainedRatio cells are under-constrained
+    const int UnderConstrainedRatio = 4;
+
+    // Solves grid as DLX::solve() would, the first solution in table order for 4x4
+    bool solve(const Grid &sudoku, Grid &solution);
+    // Counts solutions up to the limit and optionally sets the first one found
+    int count(const Grid &sudoku, int limit = 2, Grid *solution = nullptr);
+    // Counts all solutions, under-constrained 9x9 grids exactly through bands (BandCounter), those of other sizes with
+    // memoized search (DLX::countMemo(), saturates at 2^64 - 1 like plain search)
+    // Stops early once cancel is set (from any thread), the count is then partial
+    BandCounter::Count countAll(const Grid &sudoku, const std::atomic<bool> *cancel = nullptr);
+}
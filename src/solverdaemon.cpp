@@ -0,0 +1,199 @@
+#include "solverdaemon.h"
+
+#include <QDebug>
+
+#include <algorithm>
+#include <cstring>
+
+const int SolverDaemon::MaxFrameSize = 1024 * 1024;
+const int SolverDaemon::LatencySamples = 10000;
+const int SolverDaemon::ProbeTimeout = 1000;
+
+namespace {
+    template <typename T>
+    T read(const char *data) {
+        T value;
+        memcpy(&value, data, sizeof(T));
+        return value;
+    }
+
+    template <typename T>
+    void append(QByteArray &data, T value) {
+        data.append(reinterpret_cast<const char *>(&value), sizeof(T));
+    }
+}
+
+SolverDaemon::SolverDaemon(int threads, QObject *parent) : QObject(parent),
+        pool(threads, [this](const QList<SolverPool::Job> &jobs) { complete(jobs); }) {
+    latencies.reserve(static_cast<size_t>(LatencySamples));
+    connect(&server, &QLocalServer::newConnection, this, &SolverDaemon::acceptConnections);
+}
+
+SolverDaemon::~SolverDaemon() {
+    // Sockets are children of the server, requests still being answered are never delivered
+    qDeleteAll(connections);
+}
+
+bool SolverDaemon::listen(const QString &name) {
+    // Removing the socket of a live server would take its name over
+    QLocalSocket probe;
+    probe.connectToServer(name);
+    if (probe.waitForConnected(ProbeTimeout)) {
+        probe.abort();
+        listenError = "Name " + name + " is in use by a running server";
+        return false;
+    }
+    if (probe.error() == QLocalSocket::ConnectionRefusedError) {
+        QLocalServer::removeServer(name);
+    }
+
+    listenError.clear();
+    return server.listen(name);
+}
+
+QString SolverDaemon::errorString() const {
+    return listenError.isEmpty() ? server.errorString() : listenError;
+}
+
+void SolverDaemon::acceptConnections() {
+    while (QLocalSocket *socket = server.nextPendingConnection()) {
+        Connection *connection = new Connection;
+        connection->socket = socket;
+        connections.insert(socket, connection);
+        connect(socket, &QLocalSocket::readyRead, this, &SolverDaemon::readRequests);
+        connect(socket, &QLocalSocket::disconnected, this, &SolverDaemon::dropConnection);
+    }
+}
+
+void SolverDaemon::readRequests() {
+    Connection *connection = connections.value(qobject_cast<QLocalSocket *>(sender()));
+    if (!connection) {
+        return;
+    }
+    connection->input.append(connection->socket->readAll());
+
+    // Every complete frame is queued (stats answered in place), a partial one waits for more input
+    int offset = 0;
+    while (connection->input.size() - offset >= 4) {
+        quint32 length = read<quint32>(connection->input.constData() + offset);
+        if (length > static_cast<quint32>(MaxFrameSize)) {
+            qWarning() << "Solver daemon: frame of" << length << "bytes, closing connection";
+            connection->input.clear();
+            connection->socket->disconnectFromServer();
+            return;
+        }
+        if (connection->input.size() - offset - 4 < static_cast<int>(length)) {
+            break;
+        }
+
+        QByteArray request = connection->input.mid(offset + 4, static_cast<int>(length));
+        offset += 4 + static_cast<int>(length);
+        ++requests;
+
+        quint64 tag = nextTag++;
+        connection->order.append(tag);
+        if (request.size() >= 5 && static_cast<quint8>(request.at(4)) == SolverPool::Stats) {
+            connection->responses.insert(tag, stats(request));
+        } else {
+            pending.insert(tag, {connection, std::chrono::steady_clock::now()});
+            pool.submit(tag, request);
+        }
+    }
+    connection->input.remove(0, offset);
+
+    flush(connection);
+}
+
+void SolverDaemon::dropConnection() {
+    QLocalSocket *socket = qobject_cast<QLocalSocket *>(sender());
+    Connection *connection = connections.take(socket);
+    if (!connection) {
+        return;
+    }
+
+    // Requests still being answered are dropped on delivery
+    for (auto &tag : connection->order) {
+        if (pending.contains(tag)) {
+            pending[tag].connection = nullptr;
+        }
+    }
+    delete connection;
+    socket->deleteLater();
+}
+
+void SolverDaemon::deliver() {
+    mutex.lock();
+    QList<SolverPool::Job> jobs;
+    jobs.swap(completed);
+    mutex.unlock();
+
+    auto now = std::chrono::steady_clock::now();
+    QList<Connection *> answered;
+    for (auto &job : jobs) {
+        if (!pending.contains(job.tag)) {
+            continue;
+        }
+        Pending request = pending.take(job.tag);
+
+        qint64 latency = std::chrono::duration_cast<std::chrono::microseconds>(now - request.start).count();
+        if (latencies.size() < static_cast<size_t>(LatencySamples)) {
+            latencies.push_back(latency);
+        } else {
+            latencies[nextLatency] = latency;
+        }
+        nextLatency = (nextLatency + 1) % static_cast<size_t>(LatencySamples);
+
+        if (request.connection) {
+            request.connection->responses.insert(job.tag, job.response);
+            if (!answered.contains(request.connection)) {
+                answered.append(request.connection);
+            }
+        }
+    }
+
+    for (auto &connection : answered) {
+        flush(connection);
+    }
+}
+
+void SolverDaemon::complete(const QList<SolverPool::Job> &jobs) {
+    mutex.lock();
+    bool idle = completed.isEmpty();
+    completed.append(jobs);
+    mutex.unlock();
+
+    // One wake-up of the event loop for everything completed until it delivers
+    if (idle) {
+        QMetaObject::invokeMethod(this, "deliver", Qt::QueuedConnection);
+    }
+}
+
+void SolverDaemon::flush(Connection *connection) {
+    QByteArray output;
+    while (!connection->order.isEmpty() && connection->responses.contains(connection->order.first())) {
+        QByteArray response = connection->responses.take(connection->order.takeFirst());
+        append<quint32>(output, static_cast<quint32>(response.size()));
+        output.append(response);
+    }
+    if (!output.isEmpty()) {
+        connection->socket->write(output);
+    }
+}
+
+QByteArray SolverDaemon::stats(const QByteArray &request) const {
+    std::vector<qint64> sorted(latencies);
+    std::sort(sorted.begin(), sorted.end());
+
+    QByteArray response = SolverPool::respond(request, SolverPool::Ok);
+    append<quint64>(response, requests);
+    append<quint32>(response, static_cast<quint32>(pool.queueDepth()));
+    append<quint32>(response, static_cast<quint32>(pool.inFlight()));
+    append<quint32>(response, static_cast<quint32>(pool.maxQueueDepth()));
+    append<quint32>(response, 0);
+    append<quint64>(response, pool.batches());
+    for (size_t percentile : {50, 90, 99, 100}) {
+        qint64 latency = sorted.empty() ? 0 : sorted.at((sorted.size() - 1) * percentile / 100);
+        append<quint64>(response, static_cast<quint64>(latency));
+    }
+    return response;
+}
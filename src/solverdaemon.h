@@ -0,0 +1,82 @@
+#pragma once
+
+#include <QObject>
+#include <QHash>
+#include <QLocalServer>
+#include <QLocalSocket>
+
+#include <chrono>
+#include <vector>
+
+#include "solverpool.h"
+
+// Solver shared by local services on a local socket (Unix domain socket, named pipe on Windows, run with --daemon)
+// Frames are a length (4, native byte order) followed by a request or response of SolverPool
+// Requests of all connections are batched into the worker pool, responses of a connection keep request order (so
+// clients may pipeline requests)
+// Stats requests (header only) are answered right away with requests (8), queued (4), in flight (4, being answered by
+// workers), most queued (4), reserved (4), batches (8) and latency percentiles 50, 90, 99 and 100 (8 each,
+// microseconds over recent requests)
+class SolverDaemon : public QObject {
+    Q_OBJECT
+
+public:
+    // Longer frames close the connection
+    static const int MaxFrameSize;
+    // Latencies of this many most recent requests make up the percentiles
+    static const int LatencySamples;
+    // Milliseconds listen() waits for a running daemon to accept on its name
+    static const int ProbeTimeout;
+
+    explicit SolverDaemon(int threads, QObject *parent = nullptr);
+    ~SolverDaemon();
+
+    // Listens on the socket name, fails while another server accepts on it, a stale socket left by a crashed daemon
+    // (refusing connections) is removed first
+    bool listen(const QString &name);
+    QString errorString() const;
+
+private slots:
+    void acceptConnections();
+    void readRequests();
+    void dropConnection();
+    // Writes responses completed by the workers
+    void deliver();
+
+private:
+    struct Connection {
+        QLocalSocket *socket;
+        QByteArray input;
+        QList<quint64> order; // Tags of requests not yet answered
+        QHash<quint64, QByteArray> responses; // Completed before earlier requests
+    };
+
+    struct Pending {
+        Connection *connection; // Null once disconnected
+        std::chrono::steady_clock::time_point start;
+    };
+
+    QLocalServer server;
+    QString listenError; // Name in use, otherwise errors of the server
+    QHash<QLocalSocket *, Connection *> connections;
+    QHash<quint64, Pending> pending;
+    quint64 nextTag = 0;
+    quint64 requests = 0;
+
+    // Latencies in microseconds (ring of recent requests)
+    std::vector<qint64> latencies;
+    size_t nextLatency = 0;
+
+    // Batches completed by workers, not yet delivered
+    QMutex mutex;
+    QList<SolverPool::Job> completed;
+
+    // Last, workers are stopped first
+    SolverPool pool;
+
+    // Hands a batch completed on a worker thread over to the event loop
+    void complete(const QList<SolverPool::Job> &jobs);
+    // Writes responses of a connection up to the first request still being answered
+    void flush(Connection *connection);
+    QByteArray stats(const QByteArray &request) const;
+};
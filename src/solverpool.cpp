@@ -0,0 +1,245 @@
+#include "solverpool.h"
+#include "dlx.h"
+#include "rater.h"
+
+#include <QPair>
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+
+const int SolverPool::HeaderSize = 12;
+const int SolverPool::ResponseHeaderSize = 8;
+const int SolverPool::MaxBatch = 32;
+const int SolverPool::MaxCountLimit = 1 << 16;
+const int SolverPool::MaxCachedSizes = 2;
+
+namespace {
+    template <typename T>
+    T read(const char *data) {
+        T value;
+        memcpy(&value, data, sizeof(T));
+        return value;
+    }
+
+    template <typename T>
+    void append(QByteArray &data, T value) {
+        data.append(reinterpret_cast<const char *>(&value), sizeof(T));
+    }
+
+    // Solver of a size from a cache in order of use (most recent first), the least recently used is evicted when full
+    template <typename T>
+    T &cached(QList<QPair<int, T *>> &cache, int size, const std::atomic<bool> *cancel) {
+        for (int i = 0; i < cache.size(); ++i) {
+            if (cache.at(i).first == size) {
+                cache.move(i, 0);
+                return *cache.first().second;
+            }
+        }
+
+        if (cache.size() >= SolverPool::MaxCachedSizes) {
+            delete cache.takeLast().second;
+        }
+        std::unique_ptr<T> solver(new T(size));
+        solver->setCancel(cancel);
+        cache.prepend(qMakePair(size, solver.get()));
+        return *solver.release();
+    }
+}
+
+struct SolverPool::Solvers {
+    const std::atomic<bool> *cancel;
+    QList<QPair<int, DLX *>> dlx;
+    QList<QPair<int, Rater *>> raters;
+
+    explicit Solvers(const std::atomic<bool> *cancel) : cancel(cancel) {
+    }
+
+    ~Solvers() {
+        clear();
+    }
+
+    void clear() {
+        for (auto &solver : dlx) {
+            delete solver.second;
+        }
+        for (auto &rater : raters) {
+            delete rater.second;
+        }
+        dlx.clear();
+        raters.clear();
+    }
+};
+
+SolverPool::SolverPool(int threads, const Done &done) : done(done), threadCount(std::max(threads, 1)) {
+    for (int t = 0; t < threadCount; ++t) {
+        workers.emplace_back(&SolverPool::work, this);
+    }
+}
+
+SolverPool::~SolverPool() {
+    mutex.lock();
+    stopping = true;
+    jobs.clear();
+    mutex.unlock();
+    cancelled = true;
+    queued.wakeAll();
+
+    for (auto &worker : workers) {
+        worker.join();
+    }
+}
+
+void SolverPool::submit(quint64 tag, const QByteArray &request) {
+    mutex.lock();
+    jobs.append({tag, request, QByteArray()});
+    maxJobs = std::max(maxJobs, jobs.size());
+    mutex.unlock();
+    queued.wakeOne();
+}
+
+int SolverPool::queueDepth() const {
+    QMutexLocker locker(&mutex);
+    return jobs.size();
+}
+
+int SolverPool::inFlight() const {
+    QMutexLocker locker(&mutex);
+    return activeJobs;
+}
+
+int SolverPool::maxQueueDepth() const {
+    QMutexLocker locker(&mutex);
+    return maxJobs;
+}
+
+quint64 SolverPool::batches() const {
+    QMutexLocker locker(&mutex);
+    return batchCount;
+}
+
+QByteArray SolverPool::respond(const QByteArray &request, Status status) {
+    QByteArray response;
+    response.reserve(ResponseHeaderSize);
+    append<quint32>(response, request.size() >= 4 ? read<quint32>(request.constData()) : 0);
+    append<quint8>(response, request.size() >= 5 ? static_cast<quint8>(request.at(4)) : 0);
+    append<quint8>(response, static_cast<quint8>(status));
+    append<quint16>(response, 0);
+    return response;
+}
+
+void SolverPool::work() {
+    Solvers solvers(&cancelled);
+    QList<Job> batch;
+
+    while (true) {
+        batch.clear();
+
+        mutex.lock();
+        while (jobs.isEmpty() && !stopping) {
+            queued.wait(&mutex);
+        }
+        if (jobs.isEmpty()) {
+            mutex.unlock();
+            return;
+        }
+
+        // Fair share of the queue for each worker, a short queue goes to one worker at once
+        int take = std::min(MaxBatch, (jobs.size() + threadCount - 1) / threadCount);
+        for (int i = 0; i < take; ++i) {
+            batch.append(jobs.takeFirst());
+        }
+        ++batchCount;
+        activeJobs += take;
+        bool more = !jobs.isEmpty();
+        mutex.unlock();
+        if (more) {
+            queued.wakeOne();
+        }
+
+        for (auto &job : batch) {
+            job.response = answer(job.request, solvers);
+            // Searches stopped early have partial answers
+            if (cancelled) {
+                job.response = respond(job.request, Failed);
+            }
+        }
+        done(batch);
+
+        mutex.lock();
+        activeJobs -= batch.size();
+        mutex.unlock();
+    }
+}
+
+QByteArray SolverPool::answer(const QByteArray &request, Solvers &solvers) {
+    // Solvers left by an exception are rebuilt
+    try {
+        return answerOrThrow(request, solvers);
+    } catch (...) {
+        solvers.clear();
+        return respond(request, Failed);
+    }
+}
+
+QByteArray SolverPool::answerOrThrow(const QByteArray &request, Solvers &solvers) {
+    if (request.size() < HeaderSize) {
+        return respond(request, InvalidRequest);
+    }
+
+    const char *data = request.constData();
+    int type = static_cast<quint8>(data[4]);
+    int size = static_cast<quint8>(data[5]);
+    quint32 limit = read<quint32>(data + 8);
+    if (type != Solve && type != Count && type != Rate) {
+        return respond(request, UnknownType);
+    }
+    if (size < 1 || size > 64 || request.size() != HeaderSize + size * size
+            || (type == Count && (limit < 1 || limit > static_cast<quint32>(MaxCountLimit)))) {
+        return respond(request, InvalidRequest);
+    }
+
+    const quint8 *givens = reinterpret_cast<const quint8 *>(data + HeaderSize);
+    for (int i = 0; i < size * size; ++i) {
+        if (givens[i] > size) {
+            return respond(request, InvalidRequest);
+        }
+    }
+
+    QByteArray response = respond(request, Ok);
+    if (type == Rate) {
+        Rater &rater = cached(solvers.raters, size, solvers.cancel);
+
+        Grid puzzle;
+        for (int i = 0; i < size; ++i) {
+            GridRow row;
+            for (int j = 0; j < size; ++j) {
+                row.append(givens[i * size + j]);
+            }
+            puzzle.append(row);
+        }
+        Rater::Rating rating = rater.rate(puzzle);
+
+        append<quint32>(response, static_cast<quint32>(rating.solutions));
+        append<quint32>(response, static_cast<quint32>(rating.nakedSingles));
+        append<quint32>(response, static_cast<quint32>(rating.hiddenSingles));
+        append<quint32>(response, 0);
+        append<double>(response, rating.score);
+        append<quint64>(response, rating.stats.nodes);
+        return response;
+    }
+
+    DLX &dlx = cached(solvers.dlx, size, solvers.cancel);
+
+    if (type == Solve) {
+        // Solution written in place behind the count
+        int offset = response.size();
+        response.append(QByteArray(4 + size * size, 0));
+        int solutions = dlx.count(givens, reinterpret_cast<quint8 *>(response.data() + offset + 4), 1);
+        quint32 count = static_cast<quint32>(solutions);
+        memcpy(response.data() + offset, &count, sizeof(count));
+    } else {
+        append<quint32>(response, static_cast<quint32>(dlx.count(givens, nullptr, static_cast<int>(limit))));
+    }
+    return response;
+}
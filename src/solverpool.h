@@ -0,0 +1,94 @@
+#pragma once
+
+#include <QByteArray>
+#include <QList>
+#include <QMutex>
+#include <QWaitCondition>
+
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <vector>
+
+// Worker threads answering binary solver requests, queued requests are taken in batches (one lock and one completion
+// per batch), each worker keeps reusable solvers and raters of the grid sizes it used last
+//
+// Requests (native byte order): header [id (4), type (1), size (1), reserved (2), limit (4)] followed by givens
+// (size ^ 2 bytes, row by row, 0 for empty), limit is only read by count requests
+// Responses: header [id (4), type (1), status (1), reserved (2)] followed by (ok status only):
+// - Solve: solutions (4, 0 or 1) and the solution (size ^ 2 bytes, zeros without one)
+// - Count: solutions (4, up to limit)
+// - Rate: solutions (4, up to 2), naked singles (4), hidden singles (4), reserved (4), score (8, double), nodes (8)
+class SolverPool {
+public:
+    enum Type {
+        Solve = 1,
+        Count = 2,
+        Rate = 3,
+        Stats = 4 // Answered by the daemon, not the workers
+    };
+
+    enum Status {
+        Ok = 0,
+        // Too short, size out of range, givens not size ^ 2 or a value above size, limit below 1 or above MaxCountLimit
+        InvalidRequest = 1,
+        UnknownType = 2,
+        Failed = 3 // Answering threw (out of memory) or the pool stopped first
+    };
+
+    static const int HeaderSize;
+    static const int ResponseHeaderSize;
+    // Most requests a worker takes at once
+    static const int MaxBatch;
+    // Most solutions a count request may ask for
+    static const int MaxCountLimit;
+    // Grid sizes a worker keeps a solver and rater of, the least recently used is rebuilt when needed again
+    static const int MaxCachedSizes;
+
+    struct Job {
+        quint64 tag;
+        QByteArray request;
+        QByteArray response;
+    };
+
+    // Called on the worker thread with every batch it answered
+    using Done = std::function<void(const QList<Job> &jobs)>;
+
+    SolverPool(int threads, const Done &done);
+    // Drops the queued requests, stops those being answered early (answered as failed), then stops the workers
+    ~SolverPool();
+
+    // Queues a request, answered under its tag
+    void submit(quint64 tag, const QByteArray &request);
+    // Requests waiting for a worker, those being answered, the most waiting at once and batches taken so far
+    int queueDepth() const;
+    int inFlight() const;
+    int maxQueueDepth() const;
+    quint64 batches() const;
+
+    // Response header with the id and type of a request
+    static QByteArray respond(const QByteArray &request, Status status);
+
+private:
+    // Solvers and raters of a worker by grid size (built on first use)
+    struct Solvers;
+
+    Done done;
+    int threadCount;
+    mutable QMutex mutex;
+    QWaitCondition queued;
+    QList<Job> jobs;
+    int maxJobs = 0;
+    int activeJobs = 0; // Taken by workers, not yet done
+    quint64 batchCount = 0;
+    bool stopping = false;
+    std::atomic<bool> cancelled{false}; // Stops searches of requests being answered
+    std::vector<std::thread> workers;
+
+    // Takes batches until stopped
+    void work();
+    // Fails the request instead of throwing
+    static QByteArray answer(const QByteArray &request, Solvers &solvers);
+    // Same, may throw (out of memory)
+    static QByteArray answerOrThrow(const QByteArray &request, Solvers &solvers);
+};
@@ -0,0 +1,260 @@
+#include "solvestore.h"
+
+#include <cstring>
+
+#if defined(Q_OS_WIN)
+#include <io.h>
+#elif defined(Q_OS_UNIX)
+#include <unistd.h>
+#endif
+
+namespace {
+    const char Magic[8] = {'S', 'D', 'L', 'X', 'S', 'T', 'O', 'R'};
+    const quint32 Version = 1;
+
+    const qint64 HeaderSize = 16;
+    const qint64 RecordHeaderSize = 16; // length, size, verdict, reserved, hash
+    const qint64 ChecksumSize = 4;
+
+    template <typename T>
+    T read(const uchar *data) {
+        T value;
+        memcpy(&value, data, sizeof(T));
+        return value;
+    }
+
+    template <typename T>
+    void write(QByteArray &data, qint64 offset, T value) {
+        memcpy(data.data() + offset, &value, sizeof(T));
+    }
+
+    qint64 recordLength(int size, SolveCache::Verdict verdict) {
+        qint64 cells = size * size;
+        return RecordHeaderSize + (verdict == SolveCache::Verdict::Unique ? 2 * cells : cells) + ChecksumSize;
+    }
+}
+
+SolveStore::SolveStore(const QString &path, Durability durability) : durability(durability), file(path),
+        lockFile(path + ".lock") {
+}
+
+SolveStore::~SolveStore() {
+    if (map) {
+        file.unmap(map);
+    }
+    file.close();
+}
+
+bool SolveStore::open() {
+    QMutexLocker locker(&mutex);
+
+    if (!file.open(QIODevice::ReadWrite)) {
+        return false;
+    }
+
+    // Header is written by whichever process creates the file
+    if (!lockFile.lock()) {
+        file.close();
+        return false;
+    }
+    if (file.size() == 0) {
+        QByteArray header(static_cast<int>(HeaderSize), 0);
+        memcpy(header.data(), Magic, sizeof(Magic));
+        write(header, 8, Version);
+        file.write(header);
+        sync();
+    }
+    lockFile.unlock();
+
+    validEnd = HeaderSize;
+    if (file.size() >= HeaderSize) {
+        refresh();
+    }
+    if (!map || memcmp(map, Magic, sizeof(Magic)) != 0 || read<quint32>(map + 8) != Version) {
+        if (map) {
+            file.unmap(map);
+            map = nullptr;
+        }
+        file.close();
+        return false;
+    }
+
+    return true;
+}
+
+bool SolveStore::isOpen() const {
+    return map != nullptr;
+}
+
+bool SolveStore::find(const Grid &givens, quint64 hash, SolveCache::Verdict &verdict, QByteArray &solution) {
+    QByteArray cells = toCells(givens);
+
+    QMutexLocker locker(&mutex);
+    if (!map) {
+        return false;
+    }
+
+    // Records appended by other processes since last miss are only indexed now
+    qint64 offset = -1;
+    for (int attempt = 0; attempt < 2 && offset < 0; ++attempt) {
+        if (attempt > 0 && !refresh()) {
+            break;
+        }
+        for (auto &candidate : index.values(hash)) {
+            if (matches(candidate, hash, cells)) {
+                offset = candidate;
+                break;
+            }
+        }
+    }
+    if (offset < 0) {
+        return false;
+    }
+
+    verdict = static_cast<SolveCache::Verdict>(map[offset + 5]);
+    solution.clear();
+    if (verdict == SolveCache::Verdict::Unique) {
+        solution = QByteArray(reinterpret_cast<const char *>(map + offset + RecordHeaderSize + cells.size()), cells.size());
+    }
+    return true;
+}
+
+bool SolveStore::append(const Grid &givens, quint64 hash, SolveCache::Verdict verdict, const QByteArray &solution) {
+    QByteArray cells = toCells(givens);
+    int size = givens.size();
+
+    QMutexLocker locker(&mutex);
+    if (!map || !lockFile.lock()) {
+        return false;
+    }
+
+    // Index records of other processes so the append goes to the end of valid records
+    refresh();
+    for (auto &candidate : index.values(hash)) {
+        if (matches(candidate, hash, cells)) {
+            lockFile.unlock();
+            return true;
+        }
+    }
+
+    qint64 length = recordLength(size, verdict);
+    QByteArray record(static_cast<int>(length), 0);
+    write(record, 0, static_cast<quint32>(length));
+    write(record, 4, static_cast<quint8>(size));
+    write(record, 5, static_cast<quint8>(verdict));
+    write(record, 8, hash);
+    memcpy(record.data() + RecordHeaderSize, cells.constData(), static_cast<size_t>(cells.size()));
+    if (verdict == SolveCache::Verdict::Unique) {
+        memcpy(record.data() + RecordHeaderSize + cells.size(), solution.constData(), static_cast<size_t>(cells.size()));
+    }
+    write(record, length - ChecksumSize, crc32(reinterpret_cast<const uchar *>(record.constData()), length - ChecksumSize));
+
+    // Torn tail of a crashed writer (if any) is overwritten, not truncated, as other processes may still map it
+    bool written = file.seek(validEnd) && file.write(record) == length && sync();
+    lockFile.unlock();
+
+    refresh();
+    return written;
+}
+
+bool SolveStore::sync() {
+    if (!file.flush()) {
+        return false;
+    }
+    if (durability == Durability::ProcessCrash) {
+        return true;
+    }
+
+    // Data and the file size (appends grow the file), other metadata is not needed to read records back
+#if defined(Q_OS_WIN)
+    return _commit(file.handle()) == 0;
+#elif defined(Q_OS_LINUX)
+    return fdatasync(file.handle()) == 0;
+#elif defined(Q_OS_UNIX)
+    return fsync(file.handle()) == 0;
+#else
+    return true;
+#endif
+}
+
+int SolveStore::records() const {
+    return index.size();
+}
+
+qint64 SolveStore::bytes() const {
+    return validEnd;
+}
+
+bool SolveStore::refresh() {
+    qint64 size = file.size();
+    if (size <= validEnd && map) {
+        return false;
+    }
+
+    if (size > mapSize) {
+        if (map) {
+            file.unmap(map);
+        }
+        map = file.map(0, size);
+        mapSize = map ? size : 0;
+        if (!map) {
+            return false;
+        }
+    }
+
+    // Index complete records, stopping at the first torn or corrupt one (it may still be being written)
+    int indexed = index.size();
+    while (validEnd + RecordHeaderSize + ChecksumSize <= mapSize) {
+        const uchar *record = map + validEnd;
+        qint64 length = read<quint32>(record);
+        SolveCache::Verdict verdict = static_cast<SolveCache::Verdict>(record[5]);
+        if (record[5] > static_cast<uchar>(SolveCache::Verdict::None) || length != recordLength(record[4], verdict)
+                || validEnd + length > mapSize
+                || crc32(record, length - ChecksumSize) != read<quint32>(record + length - ChecksumSize)) {
+            break;
+        }
+
+        index.insert(read<quint64>(record + 8), validEnd);
+        validEnd += length;
+    }
+
+    return index.size() > indexed;
+}
+
+bool SolveStore::matches(qint64 offset, quint64 hash, const QByteArray &cells) const {
+    const uchar *record = map + offset;
+    return read<quint64>(record + 8) == hash && record[4] * record[4] == cells.size()
+            && memcmp(record + RecordHeaderSize, cells.constData(), static_cast<size_t>(cells.size())) == 0;
+}
+
+QByteArray SolveStore::toCells(const Grid &givens) {
+    QByteArray cells;
+    cells.reserve(givens.size() * givens.size());
+    for (auto &row : givens) {
+        for (auto &value : row) {
+            cells.append(static_cast<char>(qMax(value, 0)));
+        }
+    }
+    return cells;
+}
+
+quint32 SolveStore::crc32(const uchar *data, qint64 length) {
+    // CRC-32 (IEEE 802.3), table built on first use
+    static const QList<quint32> table = [] {
+        QList<quint32> table;
+        for (quint32 i = 0; i < 256; ++i) {
+            quint32 crc = i;
+            for (int bit = 0; bit < 8; ++bit) {
+                crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320u : crc >> 1;
+            }
+            table.append(crc);
+        }
+        return table;
+    }();
+
+    quint32 crc = 0xFFFFFFFFu;
+    for (qint64 i = 0; i < length; ++i) {
+        crc = table.at(static_cast<int>((crc ^ data[i]) & 0xFF)) ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
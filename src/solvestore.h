@@ -0,0 +1,65 @@
+#pragma once
+
+#include <QByteArray>
+#include <QFile>
+#include <QLockFile>
+#include <QMultiHash>
+#include <QMutex>
+
+#include "solvecache.h"
+
+// Persistent append-only store of solve results, shared by solver processes on the same machine
+// File is memory-mapped for lookups and indexed by hash of the canonical givens in each process
+// Appends are serialized between processes with a lock file, records written by others are indexed when missed
+//
+// Layout (native byte order): header [magic (8), version (4), reserved (4)]
+// followed by records [length (4), size (1), verdict (1), reserved (2), hash (8), givens, solution, CRC-32 (4)]
+// Givens and solution (unique only) take one byte per cell, a torn or corrupt tail record ends the valid file
+class SolveStore {
+public:
+    // Guarantee of an append once it returns
+    enum class Durability {
+        ProcessCrash, // Handed to the OS, kept if the process crashes (lost on power loss or OS crash)
+        SystemCrash // Also synced to disk (fdatasync, fsync or _commit), kept on power loss or OS crash
+    };
+
+    explicit SolveStore(const QString &path, Durability durability = Durability::SystemCrash);
+    ~SolveStore();
+
+    // Opens or creates the store, false if it is not a store file or cannot be opened
+    bool open();
+    bool isOpen() const;
+
+    // Looks up canonical givens (hash from Canonicalizer::hash()), solution is set for unique verdict only
+    bool find(const Grid &givens, quint64 hash, SolveCache::Verdict &verdict, QByteArray &solution);
+    // Appends result of canonical givens, durable once returned as chosen at construction
+    bool append(const Grid &givens, quint64 hash, SolveCache::Verdict verdict, const QByteArray &solution);
+
+    // Number of indexed records and bytes of valid records
+    int records() const;
+    qint64 bytes() const;
+
+private:
+    Durability durability;
+    QMutex mutex;
+    QFile file;
+    QLockFile lockFile;
+
+    // Mapping of the file up to its size when last refreshed
+    uchar *map = nullptr;
+    qint64 mapSize = 0;
+    // End of last valid record (everything before is indexed)
+    qint64 validEnd = 0;
+    QMultiHash<quint64, qint64> index;
+
+    // Remaps the file if it grew and indexes new records, false if there were none
+    bool refresh();
+    // Finds record at offset matching givens in current mapping
+    bool matches(qint64 offset, quint64 hash, const QByteArray &cells) const;
+
+    // Flushes written data to the OS and, for system crash durability, on to disk
+    bool sync();
+
+    static QByteArray toCells(const Grid &givens);
+    static quint32 crc32(const uchar *data, qint64 length);
+};
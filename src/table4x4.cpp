@@ -0,0 +1,91 @@
+#include "table4x4.h"
+
+const int Table4x4::Size = 4;
+const int Table4x4::GridCount = 288;
+
+namespace {
+    // Fills cells in row-major order with values not yet used in their row, column or region
+    void fillGrids(int cell, quint32 packed, QList<quint32> &grids) {
+        if (cell == Table4x4::Size * Table4x4::Size) {
+            grids.append(packed);
+            return;
+        }
+
+        int row = cell / Table4x4::Size;
+        int column = cell % Table4x4::Size;
+        for (quint32 value = 0; value < static_cast<quint32>(Table4x4::Size); ++value) {
+            bool valid = true;
+            for (int other = 0; other < cell && valid; ++other) {
+                int otherRow = other / Table4x4::Size;
+                int otherColumn = other % Table4x4::Size;
+                bool peer = otherRow == row || otherColumn == column
+                        || (otherRow / 2 == row / 2 && otherColumn / 2 == column / 2);
+                valid = !peer || ((packed >> (2 * other)) & 3) != value;
+            }
+            if (valid) {
+                fillGrids(cell + 1, packed | (value << (2 * cell)), grids);
+            }
+        }
+    }
+}
+
+int Table4x4::count(const Grid &sudoku, int limit, Grid *solution) {
+    // Givens as mask and values (out of range values have no solution)
+    quint32 mask = 0;
+    quint32 values = 0;
+    for (int i = 0; i < Size; ++i) {
+        for (int j = 0; j < Size; ++j) {
+            int value = sudoku.at(i).at(j);
+            if (value > Size) {
+                return 0;
+            }
+            if (value > 0) {
+                int shift = 2 * (i * Size + j);
+                mask |= 3u << shift;
+                values |= static_cast<quint32>(value - 1) << shift;
+            }
+        }
+    }
+
+    int solutions = 0;
+    for (auto &packed : grids()) {
+        if ((packed & mask) == values) {
+            if (solutions == 0 && solution) {
+                *solution = toGrid(packed);
+            }
+            if (++solutions >= limit) {
+                break;
+            }
+        }
+    }
+
+    return solutions;
+}
+
+bool Table4x4::solve(const Grid &sudoku, Grid &solution) {
+    return count(sudoku, 1, &solution) > 0;
+}
+
+const QList<quint32> &Table4x4::grids() {
+    static const QList<quint32> table = [] {
+        QList<quint32> table;
+        table.reserve(GridCount);
+        fillGrids(0, 0, table);
+        return table;
+    }();
+    return table;
+}
+
+Grid Table4x4::toGrid(quint32 packed) {
+    Grid sudoku;
+    sudoku.reserve(Size);
+    for (int i = 0; i < Size; ++i) {
+        GridRow row;
+        row.reserve(Size);
+        for (int j = 0; j < Size; ++j) {
+            row.append(static_cast<int>((packed >> (2 * (i * Size + j))) & 3) + 1);
+        }
+        sudoku.append(row);
+    }
+    return sudoku;
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "dlx.h"
+
+// All 288 complete 4x4 grids, 2 bits per cell (value - 1) in row-major order from the lowest bits
+// Queries filter the table against givens with a mask instead of building an exact cover matrix
+class Table4x4 {
+public:
+    static const int Size;
+    static const int GridCount;
+
+    // Counts solutions of 4x4 grid up to the limit and optionally sets the first one (in table order)
+    static int count(const Grid &sudoku, int limit = 2, Grid *solution = nullptr);
+    static bool solve(const Grid &sudoku, Grid &solution);
+
+    // Table in lexicographic order, built on first use
+    static const QList<quint32> &grids();
+
+    static Grid toGrid(quint32 packed);
+};
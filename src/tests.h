@@ -2,6 +2,9 @@
 
 #include <QList>
 #include <QString>
+#include <QStringList>
+
+#include "constraintplan.h"
 
 namespace Tests {
     struct Test {
@@ -206,6 +209,188 @@ namespace Tests {
         },
     };
 
+    // Difficulty classes of 9x9 tests in increasing order (rating must rank every test above the previous class)
+    static const QList<QList<QString>> ratingOrder = {
+        {"Naked Singles"},
+        {"Hidden Singles"},
+        {"Hard 1", "Hard 2", "Hard 3", "Hard 4", "Hard 5"},
+        {"Golden Nugget [Extremely Hard]"}
+    };
+
+    // 9x9 tests with unique solutions minimized on start (complete grid down to a locally minimal puzzle)
+    static const QList<QString> minimizer = {
+        "Completed Puzzle",
+        "Naked Singles",
+        "Hidden Singles",
+        "Golden Nugget [Extremely Hard]"
+    };
+
+    // Solutions counted up to symmetry of the puzzle (orbits) and in total
+    struct OrbitTest {
+        QString title;
+        QString input;
+        int orbits;
+        int solutions;
+    };
+
+    static const QList<OrbitTest> orbits = {
+        {
+            "Empty 4x4",
+            "................",
+            2, 288
+        },
+        {
+            "Two Bands 9x9",
+            "123456789456789123789123456234567891567891234891234567...........................",
+            54, 1728
+        }
+    };
+
+    // Solutions of under-constrained grids in total (Solver::countAll() counts 9x9 through bands), checked by plain search
+    struct CountTest {
+        QString title;
+        QString input;
+        quint64 solutions;
+    };
+
+    static const QList<CountTest> counts = {
+        {
+            "Sparse 9x9 A",
+            ".5..6.23..9.31..6.....9.87..38.............1..654.....3....8...5.................",
+            73810
+        },
+        {
+            "Sparse 9x9 B",
+            ".51.........3.7.6...........381.........2...8...48..2.3.9...........168.....5..9.",
+            49100
+        }
+    };
+
+    // Exact counts of 9x9 grids beyond 64 bits (Solver::countAll() counts through bands)
+    struct GridCountTest {
+        QString title;
+        QString input;
+        QString solutions;
+    };
+
+    static const QList<GridCountTest> gridCounts = {
+        {
+            "Empty",
+            ".................................................................................",
+            "6670903752021072936960"
+        },
+        {
+            "Single Given",
+            "5................................................................................",
+            "741211528002341437440"
+        }
+    };
+
+    // Generic exact cover problems (rows as column indices, secondary columns after primary)
+    struct ExactCoverTest {
+        QString title;
+        int primaryColumns;
+        int secondaryColumns;
+        QList<QList<int>> rows;
+        int solutions;
+        QList<QList<int>> colors; // Parallel to rows (0 no color), empty without colors
+        QList<QList<int>> multiplicities; // Primary columns as {column, lo, hi}, others are covered exactly once
+    };
+
+    static const QList<ExactCoverTest> exactCovers = {
+        {
+            "Knuth's Example", // Dancing Links paper
+            7, 0,
+            {{2, 4, 5}, {0, 3, 6}, {1, 2, 5}, {0, 3}, {1, 6}, {3, 4, 6}},
+            1,
+            {},
+            {}
+        },
+        {
+            "4 Queens", // Ranks and files primary, diagonals secondary
+            8, 14,
+            {{0, 4, 8, 18}, {0, 5, 9, 17}, {0, 6, 10, 16}, {0, 7, 11, 15},
+             {1, 4, 9, 19}, {1, 5, 10, 18}, {1, 6, 11, 17}, {1, 7, 12, 16},
+             {2, 4, 10, 20}, {2, 5, 11, 19}, {2, 6, 12, 18}, {2, 7, 13, 17},
+             {3, 4, 11, 21}, {3, 5, 12, 20}, {3, 6, 13, 19}, {3, 7, 14, 18}},
+            2,
+            {},
+            {}
+        },
+        {
+            "Knuth's Colored Example", // TAOCP 7.2.2.1, secondary x and y shared by rows of the same color
+            3, 2,
+            {{0, 1, 3, 4}, {0, 2, 3, 4}, {0, 3}, {1, 3}, {2, 4}},
+            1,
+            {{0, 0, 0, 1}, {0, 0, 1, 0}, {0, 2}, {0, 1}, {0, 2}},
+            {}
+        },
+        {
+            "Multiplicities", // First column covered once or twice, repeated rows are distinct
+            2, 0,
+            {{0}, {0}, {0, 1}, {1}},
+            6,
+            {},
+            {{0, 1, 2}}
+        }
+    };
+
+    struct VariantTest {
+        QString title;
+        int size;
+        int families; // ConstraintPlan::Family flags
+        QList<int> regions; // Jigsaw regions by cell, empty for boxes
+        QList<QList<int>> cages; // Killer cages as {sum, cells...}
+        int solutions; // Of the empty grid, -1 if it is only solved
+    };
+
+    static const QList<VariantTest> variants = {
+        {"4x4 X", 4, ConstraintPlan::Diagonals, {}, {}, 48},
+        {"4x4 Windoku", 4, ConstraintPlan::Windows, {}, {}, 168},
+        {"4x4 Anti-King", 4, ConstraintPlan::AntiKing, {}, {}, 0},
+        {"4x4 Anti-Knight", 4, ConstraintPlan::AntiKnight, {}, {}, 24},
+        {"4x4 Killer", 4, 0, {}, {{3, 0, 1}, {9, 5, 9, 10}}, 16},
+        {"6x6 Boxes 2x3", 6, 0, {}, {}, -1},
+        {"9x9 Windoku", 9, ConstraintPlan::Windows, {}, {}, -1},
+        {
+            "9x9 Jigsaw", 9, 0,
+            {0, 0, 0, 0, 1, 1, 1, 1, 2,
+             0, 1, 1, 1, 1, 2, 2, 2, 2,
+             0, 0, 0, 0, 1, 2, 2, 2, 5,
+             3, 3, 3, 4, 4, 4, 4, 2, 5,
+             3, 3, 3, 4, 4, 7, 5, 5, 5,
+             3, 3, 3, 4, 4, 7, 5, 8, 5,
+             6, 6, 6, 6, 4, 7, 5, 8, 5,
+             6, 6, 7, 6, 7, 7, 8, 8, 8,
+             6, 6, 7, 7, 7, 8, 8, 8, 8},
+            {},
+            -1
+        }
+    };
+
+    // Grids in order of MultiGrid::samuraiOrigins()
+    struct MultiGridTest {
+        QString title;
+        QStringList inputs;
+        QStringList expectedResults;
+    };
+
+    static const QList<MultiGridTest> samurai = {
+        {
+            "Samurai",
+            {"1..4..7.....123....567.......2.4......7..28.5.456.7..2..15......6..31........8...",
+             "31.945.....6.12.4.9.5....1..31.6.87.79.2.1.6.....7.2..1..698........7.......2....",
+             "......1...............8....1....576.86.3.2.4..5.....1.31..7.8.....2......4.89....",
+             "..7.6931...3..........2..4.31.28....7....4.5..8..96.3.94..32.6.8....1......9....1",
+             "8..1..4..........3....57.8...394.......3.2....5..6.3.......487.6..2..5.4.......31"},
+            {"123456789789123456456789123312845967697312845845697312231574698968231574574968231",
+             "312945786876312945945786312231564879798231564564879231123698457689457123457123698",
+             "698457123574123689231689457123945768867312945459768312312574896986231574745896231",
+             "457869312123457986698123745314285679769314258285796134941532867872641593536978421",
+             "896123457574689123231457689123945768768312945459768312312594876687231594945876231"}
+        }
+    };
+
     inline int size() {
         return s9x9.size() + s16x16.size();
     }
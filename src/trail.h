@@ -0,0 +1,45 @@
+#pragma once
+
+#include <QtGlobal>
+
+#include <vector>
+
+// Undo log of backtracking engines that change their state words in place (in any order, not only symmetrically)
+// Each change records the address and old value of its word, undo() restores back to a mark in a tight loop, so
+// backtracking costs as much as actually changed since the mark instead of retracing every cover in reverse
+template <typename T>
+class Trail {
+public:
+    // Records are allocated once, capacity is the most changes held at a time (by all marks together)
+    explicit Trail(int capacity) : records(static_cast<size_t>(capacity)) {
+    }
+
+    // Current position, undo() returns to it
+    int mark() const {
+        return top;
+    }
+    // Changes a word, remembering its old value
+    void assign(T &word, T value) {
+        Q_ASSERT(top < static_cast<int>(records.size()));
+        Record &record = records[static_cast<size_t>(top++)];
+        record.address = &word;
+        record.value = word;
+        word = value;
+    }
+    // Restores all words changed since the mark, latest first (words changed more than once end up as at the mark)
+    void undo(int mark) {
+        while (top > mark) {
+            const Record &record = records[static_cast<size_t>(--top)];
+            *record.address = record.value;
+        }
+    }
+
+private:
+    struct Record {
+        T *address;
+        T value;
+    };
+
+    std::vector<Record> records;
+    int top = 0;
+};